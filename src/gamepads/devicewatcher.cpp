@@ -0,0 +1,213 @@
+// class header include
+#include "devicewatcher.h"
+
+// system includes
+#include <array>
+#include <boost/log/trivial.hpp>
+#include <cerrno>
+#include <filesystem>
+
+#if defined(__linux__)
+    #include <fcntl.h>
+    #include <sys/epoll.h>
+    #include <unistd.h>
+#endif
+
+// local includes
+#include "shared/coroutines.h"
+
+//--------------------------------------------------------------------------------------------------
+
+namespace gamepads
+{
+namespace
+{
+#if defined(__linux__)
+int createEpoll()
+{
+    const int fd{::epoll_create1(EPOLL_CLOEXEC)};
+    if (fd < 0)
+    {
+        throw boost::system::system_error{errno, boost::system::system_category(), "epoll_create1"};
+    }
+    return fd;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// The motion sensors (and touchpad) of an evdev pad are reported by separate device nodes of the same parent device
+std::vector<std::string> getDeviceNodes(const std::string& path)
+{
+    std::vector<std::string>    nodes{path};
+    const std::filesystem::path device_node{path};
+    if (device_node.parent_path() != "/dev/input")
+    {
+        return nodes;
+    }
+
+    try
+    {
+        const std::filesystem::path sysfs_node{std::filesystem::path{"/sys/class/input"} / device_node.filename()};
+        const std::filesystem::path parent_device{std::filesystem::canonical(sysfs_node / "device/device")};
+        for (const auto& input : std::filesystem::directory_iterator{parent_device / "input"})
+        {
+            for (const auto& entry : std::filesystem::directory_iterator{input.path()})
+            {
+                const auto name{entry.path().filename()};
+                if (name.string().starts_with("event") && name != device_node.filename())
+                {
+                    nodes.push_back((device_node.parent_path() / name).string());
+                }
+            }
+        }
+    }
+    catch (const std::filesystem::filesystem_error& error)
+    {
+        BOOST_LOG_TRIVIAL(debug) << "Failed to look up the other device nodes of " << path << ": " << error.what();
+    }
+
+    return nodes;
+}
+#endif
+}  // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+DeviceWatcher::DeviceWatcher([[maybe_unused]] const boost::asio::any_io_executor& executor)
+#if defined(__linux__)
+    : m_epoll{executor, createEpoll()}
+    , m_timeout_timer{executor}
+#endif
+{
+}
+
+//--------------------------------------------------------------------------------------------------
+
+DeviceWatcher::~DeviceWatcher()
+{
+    closeDevices();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void DeviceWatcher::watch([[maybe_unused]] const std::vector<std::string>& paths)
+{
+#if defined(__linux__)
+    closeDevices();
+
+    m_can_wait = true;
+    for (const auto& path : paths)
+    {
+        bool is_watched{false};
+        for (const auto& node : path.empty() ? std::vector<std::string>{} : getDeviceNodes(path))
+        {
+            const int fd{::open(node.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC)};
+            if (fd < 0)
+            {
+                const boost::system::error_code error{errno, boost::system::system_category()};
+                BOOST_LOG_TRIVIAL(debug) << "Failed to open " << node << ": [" << error << "] " << error.message();
+                continue;
+            }
+
+            epoll_event event{};
+            event.events  = EPOLLIN;
+            event.data.fd = fd;
+            if (::epoll_ctl(m_epoll.native_handle(), EPOLL_CTL_ADD, fd, &event) != 0)
+            {
+                const boost::system::error_code error{errno, boost::system::system_category()};
+                BOOST_LOG_TRIVIAL(debug) << "Failed to watch " << node << ": [" << error << "] " << error.message();
+                ::close(fd);
+                continue;
+            }
+
+            m_device_fds.push_back(fd);
+            is_watched = is_watched || node == path;
+        }
+
+        if (!is_watched)
+        {
+            BOOST_LOG_TRIVIAL(info) << "Can not wait for the reports of the pad at \"" << path
+                                    << "\", polling the pads instead.";
+            m_can_wait = false;
+        }
+    }
+
+    if (!m_can_wait)
+    {
+        closeDevices();
+    }
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool DeviceWatcher::canWait() const
+{
+    return m_can_wait;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+boost::asio::awaitable<void> DeviceWatcher::wait([[maybe_unused]] std::chrono::milliseconds timeout)
+{
+#if defined(__linux__)
+    // The expiry ends the wait for the devices. Note: the expiry of an earlier wait might still be queued, it must not
+    // end this one.
+    const auto wait_id{++m_wait_id};
+    m_timeout_timer.expires_after(timeout);
+    m_timeout_timer.async_wait(
+        [this, wait_id](const boost::system::error_code& error)
+        {
+            if (!error && wait_id == m_wait_id)
+            {
+                m_epoll.cancel();
+            }
+        });
+
+    co_await m_epoll.async_wait(boost::asio::posix::descriptor_base::wait_read, shared::use_nothrow_awaitable);
+    m_timeout_timer.cancel();
+    drainDevices();
+#else
+    co_return;
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void DeviceWatcher::closeDevices()
+{
+#if defined(__linux__)
+    for (const int fd : m_device_fds)
+    {
+        // Closing it also removes it from the epoll set
+        ::close(fd);
+    }
+    m_device_fds.clear();
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void DeviceWatcher::drainDevices()
+{
+#if defined(__linux__)
+    // Large enough for a batch of evdev events or a whole hidraw report
+    std::array<std::uint8_t, 1024> buffer;
+    for (const int fd : m_device_fds)
+    {
+        ssize_t result;
+        do
+        {
+            result = ::read(fd, buffer.data(), buffer.size());
+        } while (result > 0 || (result < 0 && errno == EINTR));
+
+        if (result < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            // E.g. the pad has been unplugged, SDL will report its removal on one of the next pumps. Until then, the
+            // node would be reported as readable over and over.
+            ::epoll_ctl(m_epoll.native_handle(), EPOLL_CTL_DEL, fd, nullptr);
+        }
+    }
+#endif
+}
+}  // namespace gamepads
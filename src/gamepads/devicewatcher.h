@@ -0,0 +1,58 @@
+#pragma once
+
+// system includes
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/move/core.hpp>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+    #include <boost/asio/posix/stream_descriptor.hpp>
+#endif
+
+// local includes
+
+//--------------------------------------------------------------------------------------------------
+
+namespace gamepads
+{
+// Lets the input loop sleep until one of the open pads reports anything (Linux only). SDL can not do that without a
+// video subsystem, its `SDL_WaitEventTimeout` then just pumps the events and sleeps in 1 ms steps.
+//
+// The kernel hands every report of a device node (evdev or hidraw) to each of its open handles, so the device nodes
+// of the pads are opened a second time and waited for here. The reports read from them are dropped, SDL reads the same
+// ones from its own handles when the events are pumped.
+//
+// A pad whose device node can not be opened (e.g. a virtual one or one that SDL talks to over libusb) can not be waited
+// for, in which case the input loop has to poll.
+class DeviceWatcher final
+{
+    BOOST_MOVABLE_BUT_NOT_COPYABLE(DeviceWatcher)
+
+public:
+    explicit DeviceWatcher(const boost::asio::any_io_executor& executor);
+    ~DeviceWatcher();
+
+    // Replaces the watched pads with the ones behind the given device nodes (as reported by SDL)
+    void                         watch(const std::vector<std::string>& paths);
+    // Whether all of the watched pads can be waited for
+    bool                         canWait() const;
+    // Waits until any of the pads reports something, or the timeout expires
+    boost::asio::awaitable<void> wait(std::chrono::milliseconds timeout);
+
+private:
+    void closeDevices();
+    void drainDevices();
+
+#if defined(__linux__)
+    boost::asio::posix::stream_descriptor m_epoll;
+    boost::asio::steady_timer             m_timeout_timer;
+    std::uint64_t                         m_wait_id{0};
+    std::vector<int>                      m_device_fds;
+#endif
+    bool m_can_wait{false};
+};
+}  // namespace gamepads
@@ -2,19 +2,27 @@
 #include "enumerator.h"
 
 // system includes
+#include <array>
+#include <boost/asio/post.hpp>
 #include <boost/asio/steady_timer.hpp>
 #include <boost/asio/use_awaitable.hpp>
 #include <filesystem>
 #include <optional>
+#include <span>
 #include <stdexcept>
+#include <thread>
 
 // local includes
+#include "devicewatcher.h"
 #include "gamepadmanager.h"
 #include "handleaxisupdate.h"
 #include "handlebatteryupdate.h"
 #include "handlebuttonupdate.h"
 #include "handlesensorupdate.h"
 #include "handletouchpadupdate.h"
+#include "shared/coroutines.h"
+#include "shared/gamepaddatasnapshots.h"
+#include "shared/padindexset.h"
 
 //--------------------------------------------------------------------------------------------------
 
@@ -24,6 +32,20 @@ namespace
 {
 using namespace std::chrono_literals;
 
+// Upper bound for waiting for the reports of the pads, so that the hotplug events (which only show up when the events
+// are pumped) and the periodic checks are still handled in time
+constexpr auto MAX_EVENT_WAIT{100ms};
+
+// Used when the pads can not be waited for
+constexpr auto POLL_INTERVAL{1ms};
+
+// Number of events that are taken from the SDL queue at once
+constexpr std::size_t EVENT_BATCH_SIZE{64};
+
+// The immediate updates of a batch are published without giving the workers a chance to read them in between, so
+// all of them have to fit into the held snapshots of a pad
+static_assert(EVENT_BATCH_SIZE <= shared::GamepadDataSnapshots::HELD_CAPACITY);
+
 //--------------------------------------------------------------------------------------------------
 
 class SdlCleanupGuard final
@@ -78,23 +100,25 @@ SdlCleanupGuard initializeSdl(std::string mapping_file)
 //--------------------------------------------------------------------------------------------------
 
 boost::asio::awaitable<void>
-    enumerateAndWatch(std::function<boost::asio::awaitable<void>(const std::uint8_t)> notify_clients,
-                      std::function<std::size_t()>                                    get_number_of_active_clients,
+    enumerateAndWatch(NotifyClients notify_clients, GetNumberOfActiveClients get_number_of_active_clients,
                       const std::regex& controller_name_filter, const std::string& mapping_file,
-                      bool sensor_auto_toggle, shared::GamepadDataContainer& gamepad_data)
+                      bool sensor_auto_toggle, bool busy_spin, IdleBackoff& idle_backoff,
+                      shared::GamepadDataContainer& gamepad_data, shared::PortInfoGenerations& port_info_generations)
 {
-    BOOST_ASSERT(notify_clients);
-    BOOST_ASSERT(get_number_of_active_clients);
-
     const auto                            sdl_cleanup_guard{initializeSdl(mapping_file)};
-    boost::asio::steady_timer             timer(co_await boost::asio::this_coro::executor);
+    const auto                            executor{co_await boost::asio::this_coro::executor};
+    boost::asio::steady_timer             poll_timer{executor};
     std::chrono::steady_clock::time_point last_sensor_check_ts{std::chrono::steady_clock::now()};
     GamepadManager                        manager{controller_name_filter, gamepad_data};
+    DeviceWatcher                         device_watcher{executor};
 
-    std::set<std::uint8_t> updated_indexes;
-    shared::GamepadData*   last_device_data{nullptr};
-    std::uint32_t          last_device_id{0};
-    const auto             unload_device_data = [&last_device_data, &last_device_id]()
+    // Note: fixed size, so that the updates of the pads do not allocate
+    shared::PadIndexSet                         updated_indexes;
+    std::array<std::optional<std::uint64_t>, 4> button_changes;  // Timestamp of the pending button change of each pad
+    shared::GamepadData*                        last_device_data{nullptr};
+    std::uint32_t                               last_device_id{0};
+    std::array<SDL_Event, EVENT_BATCH_SIZE>     events;
+    const auto                                  unload_device_data = [&last_device_data, &last_device_id]()
     {
         last_device_data = nullptr;
         last_device_id   = 0;
@@ -113,43 +137,75 @@ boost::asio::awaitable<void>
         }
         return true;
     };
-    const auto data_needs_to_be_sent_now = [&last_device_data, &updated_indexes](const auto& event) -> bool
+    // The updates of a pad are merged within a batch, except for a button change that would be overwritten by a later
+    // one (e.g. a quick tap), so the pad is sent before a button change from another report is applied. The change is
+    // sent with immediate priority, so the published state is also held for the workers (see `GamepadDataSnapshots`),
+    // even though it is overwritten right away.
+    const auto button_change_needs_to_be_sent_now = [&last_device_data, &button_changes](const auto& event) -> bool
     {
         BOOST_ASSERT(last_device_data);
-        if (last_device_data->m_pad_info.m_update_ts != event.timestamp
-            && updated_indexes.contains(last_device_data->m_pad_info.m_index))
-        {
-            updated_indexes.erase(last_device_data->m_pad_info.m_index);
-            return true;
-        }
-        return false;
+        const auto& button_change{button_changes[last_device_data->m_pad_info.m_index]};
+        return button_change && *button_change != event.timestamp;
+    };
+    const auto take_priority = [&button_changes](std::uint8_t index)
+    {
+        const bool had_button_change{button_changes[index].has_value()};
+        button_changes[index].reset();
+        return had_button_change ? shared::UpdatePriority::Immediate : shared::UpdatePriority::Coalesced;
     };
-    const auto try_update_data = [&last_device_data, &updated_indexes](const auto& event, auto&& modifier)
+    const auto try_update_data =
+        [&last_device_data, &updated_indexes, &port_info_generations](const auto& event, auto&& modifier)
     {
         BOOST_ASSERT(last_device_data);
+        const auto battery{last_device_data->m_battery};
+        const bool has_gyro{last_device_data->m_sensor.m_ts != 0};
+
         const bool result{modifier(event, *last_device_data)};
         if (result)
         {
             last_device_data->m_pad_info.m_update_ts = event.timestamp;
             updated_indexes.insert(last_device_data->m_pad_info.m_index);
+
+            // Battery and gyro state are also reported as the port info
+            if (battery != last_device_data->m_battery || has_gyro != (last_device_data->m_sensor.m_ts != 0))
+            {
+                ++port_info_generations.m_values[last_device_data->m_pad_info.m_index];
+            }
         }
         return result;
     };
 
-    SDL_Event base_event;
     while (true)
     {
-        while (SDL_PollEvent(&base_event) != 0)
+        bool gamepads_changed{false};
+
+        // The joystick events are redundant to the gamepad events, so they are dropped right away instead of being
+        // handed over one by one. They can not be disabled, SDL derives the gamepad events from them.
+        SDL_PumpEvents();
+        SDL_FlushEvents(SDL_EVENT_JOYSTICK_AXIS_MOTION, SDL_EVENT_JOYSTICK_REMOVED);
+
+        const int count{SDL_PeepEvents(events.data(), static_cast<int>(events.size()), SDL_GETEVENT, SDL_EVENT_FIRST,
+                                       SDL_EVENT_LAST)};
+        if (count < 0)
+        {
+            BOOST_LOG_TRIVIAL(error) << "Failed to get the SDL events! SDL Error: " << SDL_GetError();
+        }
+
+        for (const auto& base_event : std::span{events.data(), static_cast<std::size_t>(std::max(count, 0))})
         {
             switch (base_event.type)
             {
                 case SDL_EVENT_GAMEPAD_ADDED:
                 {
+                    idle_backoff.reset();
                     const auto new_index{manager.tryOpenGamepad(base_event.gdevice.which)};
                     if (new_index)
                     {
+                        gamepads_changed = true;
+                        ++port_info_generations.m_values[*new_index];
                         updated_indexes.erase(*new_index);
-                        co_await notify_clients(*new_index);
+                        button_changes[*new_index].reset();
+                        notify_clients(*new_index, shared::UpdatePriority::Immediate);
                     }
                     break;
                 }
@@ -159,8 +215,11 @@ boost::asio::awaitable<void>
                     const auto pending_index{manager.closeGamepad(base_event.gdevice.which)};
                     if (pending_index)
                     {
+                        gamepads_changed = true;
+                        ++port_info_generations.m_values[*pending_index];
                         updated_indexes.erase(*pending_index);
-                        co_await notify_clients(*pending_index);
+                        button_changes[*pending_index].reset();
+                        notify_clients(*pending_index, shared::UpdatePriority::Immediate);
                     }
                     break;
                 }
@@ -169,11 +228,6 @@ boost::asio::awaitable<void>
                     const auto& event{base_event.gaxis};
                     if (load_device_data(event))
                     {
-                        if (data_needs_to_be_sent_now(event))
-                        {
-                            co_await notify_clients(last_device_data->m_pad_info.m_index);
-                        }
-
                         try_update_data(event, handleAxisUpdate);
                     }
                     break;
@@ -184,14 +238,17 @@ boost::asio::awaitable<void>
                     const auto& event{base_event.gbutton};
                     if (load_device_data(event))
                     {
-                        if (data_needs_to_be_sent_now(event))
+                        if (button_change_needs_to_be_sent_now(event))
                         {
-                            co_await notify_clients(last_device_data->m_pad_info.m_index);
+                            const auto index{last_device_data->m_pad_info.m_index};
+                            updated_indexes.erase(index);
+                            notify_clients(index, take_priority(index));
                         }
 
                         if (try_update_data(event, handleButtonUpdate))
                         {
                             BOOST_ASSERT(last_device_data);
+                            button_changes[last_device_data->m_pad_info.m_index] = event.timestamp;
                             tryToToggleSensor(event, *last_device_data, manager);
                         }
                     }
@@ -204,11 +261,6 @@ boost::asio::awaitable<void>
                     const auto& event{base_event.gtouchpad};
                     if (load_device_data(event))
                     {
-                        if (data_needs_to_be_sent_now(event))
-                        {
-                            co_await notify_clients(last_device_data->m_pad_info.m_index);
-                        }
-
                         try_update_data(event, handleTouchpadUpdate);
                     }
                     break;
@@ -218,11 +270,6 @@ boost::asio::awaitable<void>
                     const auto& event{base_event.gsensor};
                     if (load_device_data(event))
                     {
-                        if (data_needs_to_be_sent_now(event))
-                        {
-                            co_await notify_clients(last_device_data->m_pad_info.m_index);
-                        }
-
                         try_update_data(event, handleSensorUpdate);
                     }
                     break;
@@ -242,11 +289,6 @@ boost::asio::awaitable<void>
                     const auto& event{base_event.jbattery};
                     if (load_device_data(event))
                     {
-                        if (data_needs_to_be_sent_now(event))
-                        {
-                            co_await notify_clients(last_device_data->m_pad_info.m_index);
-                        }
-
                         try_update_data(event, handleBatteryUpdate);
                     }
                     break;
@@ -257,6 +299,11 @@ boost::asio::awaitable<void>
             }
         }
 
+        if (gamepads_changed)
+        {
+            device_watcher.watch(manager.getDevicePaths());
+        }
+
         const auto now{std::chrono::steady_clock::now()};
         if (sensor_auto_toggle && (now - last_sensor_check_ts) > 10s)
         {
@@ -268,19 +315,45 @@ boost::asio::awaitable<void>
             manager.tryChangeSensorStateForAll(enable);
         }
 
-        if (!updated_indexes.empty())
+        // Each pad updated by the batch is sent just once
+        for (const auto index : updated_indexes)
         {
-            for (const auto index : updated_indexes)
-            {
-                co_await notify_clients(index);
-            }
-            updated_indexes.clear();
+            notify_clients(index, take_priority(index));
+        }
+        updated_indexes.clear();
+
+        if (count == static_cast<int>(events.size()))
+        {
+            // There are probably more events queued already
+            continue;
+        }
+
+        const bool idle{!manager.hasOpenGamepads() || get_number_of_active_clients() == 0};
+        const auto idle_interval{idle_backoff.getInterval(idle)};
+        if (idle_interval.count() > 0)
+        {
+            // SDL keeps polling the devices while it waits for the events, so it is not pumped at all while idle
+            co_await idle_backoff.sleep(idle_interval);
+        }
+        else if (busy_spin)
+        {
+            // Trades a whole core for picking up the events as soon as possible. The thread still yields, so that the
+            // other threads with the same real-time priority can run on the core.
+            std::this_thread::yield();
+            co_await boost::asio::post(executor, boost::asio::use_awaitable);
+        }
+        else if (device_watcher.canWait())
+        {
+            // Sleep until one of the pads reports anything, instead of waking up on a fixed timer and picking the
+            // report up to a timer period later
+            co_await device_watcher.wait(MAX_EVENT_WAIT);
         }
         else
         {
-            timer.expires_after(1ms);
-            co_await timer.async_wait(boost::asio::use_awaitable);
+            poll_timer.expires_after(POLL_INTERVAL);
+            co_await poll_timer.async_wait(shared::use_nothrow_awaitable);
         }
+        idle_backoff.countWakeup(std::chrono::steady_clock::now());
     }
 }
 }  // namespace gamepads
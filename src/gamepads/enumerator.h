@@ -2,20 +2,27 @@
 
 // system includes
 #include <boost/asio/awaitable.hpp>
-#include <functional>
 #include <regex>
-#include <set>
 
 // local includes
+#include "idlebackoff.h"
+#include "shared/functionref.h"
 #include "shared/gamepaddata.h"
 
 //--------------------------------------------------------------------------------------------------
 
 namespace gamepads
 {
+using NotifyClients            = shared::FunctionRef<void(const std::uint8_t, shared::UpdatePriority)>;
+using GetNumberOfActiveClients = shared::FunctionRef<std::size_t()>;
+
+//--------------------------------------------------------------------------------------------------
+
+// Note: needs an io_context (and thread) of its own, as pumping the SDL events blocks the executor (and busy spinning
+// never leaves it idle). The callbacks are only referenced and have to outlive the coroutine.
 boost::asio::awaitable<void>
-    enumerateAndWatch(std::function<boost::asio::awaitable<void>(const std::uint8_t)> notify_clients,
-                      std::function<std::size_t()>                                    get_number_of_active_clients,
+    enumerateAndWatch(NotifyClients notify_clients, GetNumberOfActiveClients get_number_of_active_clients,
                       const std::regex& controller_name_filter, const std::string& mapping_file,
-                      bool sensor_auto_toggle, shared::GamepadDataContainer& gamepad_data);
+                      bool sensor_auto_toggle, bool busy_spin, IdleBackoff& idle_backoff,
+                      shared::GamepadDataContainer& gamepad_data, shared::PortInfoGenerations& port_info_generations);
 }  // namespace gamepads
@@ -40,6 +40,15 @@ std::string getInstanceName(std::uint32_t id)
 
     return std::string{name};
 }
+
+//--------------------------------------------------------------------------------------------------
+
+std::string getInstancePath(std::uint32_t id)
+{
+    // Note: not every pad has a device node (e.g. a virtual one)
+    const auto path{SDL_GetGamepadInstancePath(id)};
+    return path ? std::string{path} : std::string{};
+}
 }  // namespace
 
 //--------------------------------------------------------------------------------------------------
@@ -48,6 +57,7 @@ GamepadHandle::GamepadHandle(std::uint32_t id, std::uint8_t index)
     : m_handle{SDL_OpenGamepad(id)}
     , m_index{index}
     , m_name{getInstanceName(id)}
+    , m_path{getInstancePath(id)}
 {
     if (m_handle)
     {
@@ -93,6 +103,13 @@ const std::string& GamepadHandle::getName() const
 
 //--------------------------------------------------------------------------------------------------
 
+const std::string& GamepadHandle::getPath() const
+{
+    return m_path;
+}
+
+//--------------------------------------------------------------------------------------------------
+
 bool GamepadHandle::hasSensorSupport() const
 {
     return m_accel != SDL_SensorType::SDL_SENSOR_INVALID && m_gyro != SDL_SensorType::SDL_SENSOR_INVALID;
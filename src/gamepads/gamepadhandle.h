@@ -23,6 +23,7 @@ public:
     SDL_Gamepad*       getHandle() const;
     std::uint8_t       getIndex() const;
     const std::string& getName() const;
+    const std::string& getPath() const;
     bool               hasSensorSupport() const;
 
     bool refreshSensorStatus();
@@ -32,6 +33,7 @@ private:
     SDL_Gamepad*   m_handle;
     std::uint8_t   m_index;
     std::string    m_name;
+    std::string    m_path;
     SDL_SensorType m_accel{SDL_SensorType::SDL_SENSOR_INVALID};
     SDL_SensorType m_gyro{SDL_SensorType::SDL_SENSOR_INVALID};
 };
@@ -120,6 +120,25 @@ shared::GamepadData* GamepadManager::tryGetData(std::uint32_t id) const
 
 //--------------------------------------------------------------------------------------------------
 
+bool GamepadManager::hasOpenGamepads() const
+{
+    return !m_open_handles.empty();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::vector<std::string> GamepadManager::getDevicePaths() const
+{
+    std::vector<std::string> paths;
+    for (const auto& [id, handle] : m_open_handles)
+    {
+        paths.push_back(handle.getPath());
+    }
+    return paths;
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void GamepadManager::tryChangeSensorState(std::uint32_t id, const std::optional<bool>& enable)
 {
     auto open_handle_it{m_open_handles.find(id)};
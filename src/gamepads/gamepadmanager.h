@@ -5,6 +5,8 @@
 #include <map>
 #include <regex>
 #include <set>
+#include <string>
+#include <vector>
 
 // local includes
 #include "gamepadhandle.h"
@@ -24,6 +26,8 @@ public:
     std::optional<std::uint8_t> tryOpenGamepad(std::uint32_t id);
     std::optional<std::uint8_t> closeGamepad(std::uint32_t id);
     shared::GamepadData*        tryGetData(std::uint32_t id) const;
+    bool                        hasOpenGamepads() const;
+    std::vector<std::string>    getDevicePaths() const;
     void                        tryChangeSensorState(std::uint32_t id, const std::optional<bool>& enable);
     void                        tryChangeSensorStateForAll(const std::optional<bool>& enable);
 
@@ -0,0 +1,88 @@
+// class header include
+#include "idlebackoff.h"
+
+// system includes
+#include <algorithm>
+#include <boost/asio/post.hpp>
+#include <boost/log/trivial.hpp>
+
+// local includes
+#include "shared/coroutines.h"
+
+//--------------------------------------------------------------------------------------------------
+
+namespace gamepads
+{
+namespace
+{
+using namespace std::chrono_literals;
+
+constexpr auto MIN_INTERVAL{10ms};
+constexpr auto WAKEUP_LOG_INTERVAL{10s};
+}  // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+IdleBackoff::IdleBackoff(const boost::asio::any_io_executor& executor, std::chrono::milliseconds max_interval)
+    : m_max_interval{max_interval}
+    , m_timer{executor}
+    , m_wakeup_count_start{std::chrono::steady_clock::now()}
+{
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::chrono::milliseconds IdleBackoff::getInterval(bool idle)
+{
+    if (!idle)
+    {
+        reset();
+        return m_interval;
+    }
+
+    m_interval = std::min(m_interval > 0ms ? m_interval * 2 : MIN_INTERVAL, m_max_interval);
+    return m_interval;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+boost::asio::awaitable<void> IdleBackoff::sleep(std::chrono::milliseconds interval)
+{
+    // Being woken up early cancels the wait
+    m_timer.expires_after(interval);
+    co_await m_timer.async_wait(shared::use_nothrow_awaitable);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void IdleBackoff::reset()
+{
+    m_interval = 0ms;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void IdleBackoff::countWakeup(std::chrono::steady_clock::time_point now)
+{
+    ++m_wakeups;
+
+    const auto elapsed{now - m_wakeup_count_start};
+    if (elapsed >= WAKEUP_LOG_INTERVAL)
+    {
+        const auto elapsed_ms{std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()};
+        BOOST_LOG_TRIVIAL(debug) << "Input loop wakeups per second: " << (m_wakeups * 1000 / elapsed_ms)
+                                 << " (idle interval: " << m_interval.count() << "ms)";
+
+        m_wakeups            = 0;
+        m_wakeup_count_start = now;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void IdleBackoff::wake()
+{
+    // The wake up is handled on the input thread, after the input loop has started its sleep or checked the clients
+    boost::asio::post(m_timer.get_executor(), [this]() { m_timer.cancel(); });
+}
+}  // namespace gamepads
@@ -0,0 +1,47 @@
+#pragma once
+
+// system includes
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/move/core.hpp>
+#include <chrono>
+
+// local includes
+
+//--------------------------------------------------------------------------------------------------
+
+namespace gamepads
+{
+// Decides how long the input loop sleeps between pumping the SDL events. While the loop is active (there are clients
+// and open pads), it waits for the SDL events at full rate. Once it is idle, the sleep is doubled on every wakeup up to
+// the maximum interval, until the loop is active again or `wake` is called (e.g. on the first client request).
+//
+// The wakeups of the loop are counted and logged every few seconds (debug level), so that the idle budget can be
+// checked.
+class IdleBackoff final
+{
+    BOOST_MOVABLE_BUT_NOT_COPYABLE(IdleBackoff)
+
+public:
+    explicit IdleBackoff(const boost::asio::any_io_executor& executor, std::chrono::milliseconds max_interval);
+
+    // Returns how long to sleep before pumping the events again, zero means waiting for the events at full rate
+    std::chrono::milliseconds    getInterval(bool idle);
+    // Sleeps for the interval, unless `wake` is called in the meantime
+    boost::asio::awaitable<void> sleep(std::chrono::milliseconds interval);
+    // Starts the backoff over from the shortest interval
+    void                         reset();
+    void                         countWakeup(std::chrono::steady_clock::time_point now);
+
+    // Ends the current sleep. Note: can be called from any thread
+    void wake();
+
+private:
+    std::chrono::milliseconds             m_max_interval;
+    std::chrono::milliseconds             m_interval{0};
+    boost::asio::steady_timer             m_timer;
+    std::uint64_t                         m_wakeups{0};
+    std::chrono::steady_clock::time_point m_wakeup_count_start;
+};
+}  // namespace gamepads
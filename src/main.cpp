@@ -1,15 +1,30 @@
 // system includes
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/split.hpp>
 #include <boost/asio/co_spawn.hpp>
 #include <boost/asio/signal_set.hpp>
 #include <boost/asio/steady_timer.hpp>
 #include <boost/log/expressions.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/program_options.hpp>
+#include <charconv>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
 
 // local includes
 #include "gamepads/enumerator.h"
+#include "server/broadcastsettings.h"
+#include "server/clientsettings.h"
 #include "server/communication.h"
+#include "server/networksettings.h"
+#include "server/serverworker.h"
+#include "shared/coroutines.h"
+#include "shared/gamepaddatasnapshots.h"
+#include "shared/realtime.h"
 
 //--------------------------------------------------------------------------------------------------
 
@@ -19,18 +34,38 @@ using namespace std::chrono_literals;
 
 //--------------------------------------------------------------------------------------------------
 
-void exceptionHandler(std::exception_ptr exception)
+// Parses a comma separated list of CPU cores, "-1" means none
+std::optional<std::vector<int>> parseCpuList(const std::string& value)
 {
-    if (exception)
+    if (value == "-1")
     {
-        std::rethrow_exception(exception);
+        return std::vector<int>{};
     }
+
+    std::vector<std::string> items;
+    boost::split(items, value, boost::is_any_of(","));
+
+    std::vector<int> cpus;
+    for (const auto& item : items)
+    {
+        int        cpu{-1};
+        const auto result{std::from_chars(item.data(), item.data() + item.size(), cpu)};
+        if (result.ec != std::errc{} || result.ptr != item.data() + item.size() || cpu < 0)
+        {
+            return std::nullopt;
+        }
+        cpus.push_back(cpu);
+    }
+    return cpus;
 }
 
 //--------------------------------------------------------------------------------------------------
 
 bool parseProgramArgs(int argc, const char* const* const argv, int& init_delay, std::uint16_t& port,
-                      std::regex& controller_name_filter, std::string& mapping_file, bool& sensor_auto_toggle)
+                      std::regex& controller_name_filter, std::string& mapping_file, bool& sensor_auto_toggle,
+                      std::chrono::milliseconds& max_idle_interval, server::NetworkSettings& network_settings,
+                      server::ClientSettings& client_settings, server::BroadcastSettings& broadcast_settings,
+                      shared::RealtimeSettings& realtime_settings)
 {
     try
     {
@@ -40,6 +75,13 @@ bool parseProgramArgs(int argc, const char* const* const argv, int& init_delay,
         sl                      log_severity;
         std::string             filter;
         bool                    no_auto_toggle;
+        int                     client_timeout;
+        unsigned int            max_client_rate;
+        int                     broadcast_tick;
+        int                     max_idle;
+        std::string             rt_policy;
+        std::string             cpus;
+        std::size_t             prefault_heap;
         po::options_description desc("Available options");
         desc.add_options()                                                                                            //
             ("help", "print this help message")                                                                       //
@@ -53,6 +95,48 @@ bool parseProgramArgs(int argc, const char* const* const argv, int& init_delay,
             ("mappingfile", po::value<std::string>(&mapping_file),                                                    //
              "path to the optional mapping file to be used. Will try to load gamecontrollerdb.txt by default if it "  //
              "exists in the same directory.")                                                                         //
+            ("maxidleinterval", po::value<int>(&max_idle)->default_value(200),                                        //
+             "maximum time in milliseconds between checking the controllers while there are no clients or no "        //
+             "controllers, the check happens at full rate otherwise (0 = always at full rate)")                       //
+            ("udpgso", po::value<bool>(&network_settings.m_segmentation_offload)->implicit_value(true),               //
+             "send multiple packets for the same client with a single syscall using UDP segmentation offload "        //
+             "(Linux only)")                                                                                          //
+            ("iouring", po::value<bool>(&network_settings.m_io_uring)->implicit_value(true),                          //
+             "use io_uring instead of the default networking backend (Linux only, requires a build with "             //
+             "USE_IO_URING=ON)")                                                                                      //
+            ("workers", po::value<std::size_t>(&network_settings.m_workers)->default_value(1),                        //
+             "number of threads that serve the clients, each with its own socket sharing the port (Linux only)")      //
+            ("clienttimeout", po::value<int>(&client_timeout)->default_value(5000),                                   //
+             "time in milliseconds after which a client that has stopped requesting pad data is dropped")             //
+            ("maxclients", po::value<std::size_t>(&client_settings.m_max_clients)->default_value(256),                //
+             "maximum number of clients, the least recently active one is dropped to make room for a new one (split " //
+             "evenly between the workers)")                                                                           //
+            ("maxclientsperip",                                                                                       //
+             po::value<std::size_t>(&client_settings.m_max_clients_per_address)->default_value(16),                   //
+             "maximum number of clients from the same IP address (split evenly between the workers, since the "       //
+             "clients of an IP address are spread between them by their ports)")                                      //
+            ("maxclientrate", po::value<unsigned int>(&max_client_rate)->default_value(0),                            //
+             "maximum number of pad data packets per second that a client receives for each pad (0 = unlimited), "    //
+             "a client over it receives the latest pad data at its rate instead of every update")                     //
+            ("broadcasttick", po::value<int>(&broadcast_tick)->default_value(0),                                      //
+             "send the updated pads together every given number of milliseconds instead of on every update, "         //
+             "only button changes are still sent right away (0 = disabled)")                                          //
+            ("rtpriority", po::value<int>(&realtime_settings.m_priority)->default_value(0),                           //
+             "run the input and server threads with a real-time scheduling policy at this priority (1-99, 0 = "       //
+             "disabled, Linux only)")                                                                                 //
+            ("rtpolicy", po::value<std::string>(&rt_policy)->default_value("fifo"),                                   //
+             "real-time scheduling policy to use with rtpriority (fifo, rr)")                                         //
+            ("cpu", po::value<std::string>(&cpus)->default_value("-1"),                                               //
+             "pin the threads to these CPU cores (comma separated), either all of them to a single core (only with "  //
+             "a single worker) or each to its own, the input thread first and then the workers (-1 = disabled, "      //
+             "Linux only)")                                                                                           //
+            ("lockmemory", po::value<bool>(&realtime_settings.m_lock_memory)->implicit_value(true),                   //
+             "lock all the memory of the process, so that it is never paged out (Linux only)")                        //
+            ("prefaultheap", po::value<std::size_t>(&prefault_heap)->default_value(0),                                //
+             "number of MiB of heap to fault in upfront and keep, best combined with lockmemory (Linux only)")        //
+            ("busyspin", po::value<bool>(&realtime_settings.m_busy_spin)->implicit_value(true),                       //
+             "poll the controllers in a busy loop instead of sleeping until the next event, trading a whole core "    //
+             "for the lowest latency (not allowed together with both rtpriority and cpu)")                            //
             ("loglevel", po::value<sl>(&log_severity)->default_value(sl::info),                                       //
              "log level to output (trace, debug, info, warning, error, fatal)");
 
@@ -78,9 +162,110 @@ bool parseProgramArgs(int argc, const char* const* const argv, int& init_delay,
         }
 
         po::notify(vars);
+        if (client_timeout <= 0)
+        {
+            throw po::validation_error(po::validation_error::invalid_option_value, "clienttimeout");
+        }
+        if (client_settings.m_max_clients == 0 || client_settings.m_max_clients > 65536)
+        {
+            throw po::validation_error(po::validation_error::invalid_option_value, "maxclients");
+        }
+        if (client_settings.m_max_clients_per_address == 0)
+        {
+            throw po::validation_error(po::validation_error::invalid_option_value, "maxclientsperip");
+        }
+        if (network_settings.m_workers == 0 || network_settings.m_workers > 64)
+        {
+            throw po::validation_error(po::validation_error::invalid_option_value, "workers");
+        }
+        if (max_client_rate > 1000000)
+        {
+            throw po::validation_error(po::validation_error::invalid_option_value, "maxclientrate");
+        }
+        if (broadcast_tick < 0)
+        {
+            throw po::validation_error(po::validation_error::invalid_option_value, "broadcasttick");
+        }
+        if (max_idle < 0)
+        {
+            throw po::validation_error(po::validation_error::invalid_option_value, "maxidleinterval");
+        }
+        if (realtime_settings.m_priority < 0 || realtime_settings.m_priority > 99)
+        {
+            throw po::validation_error(po::validation_error::invalid_option_value, "rtpriority");
+        }
+        if (rt_policy != "fifo" && rt_policy != "rr")
+        {
+            throw po::validation_error(po::validation_error::invalid_option_value, "rtpolicy");
+        }
+        if (auto cpu_list{parseCpuList(cpus)}; cpu_list)
+        {
+            realtime_settings.m_cpus = std::move(*cpu_list);
+        }
+        else
+        {
+            throw po::validation_error(po::validation_error::invalid_option_value, "cpu");
+        }
+        if (realtime_settings.m_cpus.size() > 1 && realtime_settings.m_cpus.size() != network_settings.m_workers + 1)
+        {
+            throw po::validation_error(po::validation_error::invalid_option_value, "cpu");
+        }
+        if (realtime_settings.m_cpus.size() == 1 && network_settings.m_workers > 1)
+        {
+            // The workers would all end up sharing the same core
+            throw po::validation_error(po::validation_error::invalid_option_value, "cpu");
+        }
+        if (prefault_heap > 65536)
+        {
+            throw po::validation_error(po::validation_error::invalid_option_value, "prefaultheap");
+        }
+        if (realtime_settings.m_busy_spin && realtime_settings.m_priority > 0 && !realtime_settings.m_cpus.empty())
+        {
+            // A real-time thread that never sleeps only yields to its peers, starving every other task on its core
+            throw po::validation_error(po::validation_error::invalid_option_value, "busyspin");
+        }
+        max_idle_interval                   = std::chrono::milliseconds{max_idle};
+        broadcast_settings.m_tick_interval  = std::chrono::milliseconds{broadcast_tick};
+        client_settings.m_timeout           = std::chrono::milliseconds{client_timeout};
+        client_settings.m_min_send_interval = std::chrono::microseconds{
+            max_client_rate > 0 ? std::chrono::microseconds{1s}.count() / max_client_rate : 0};
+
         controller_name_filter = std::regex{filter, std::regex_constants::icase | std::regex_constants::ECMAScript};
         sensor_auto_toggle     = !no_auto_toggle;
+
+        realtime_settings.m_policy             = rt_policy == "fifo" ? shared::RealtimeSettings::Policy::Fifo
+                                                                     : shared::RealtimeSettings::Policy::RoundRobin;
+        realtime_settings.m_prefault_heap_size = prefault_heap * 1024 * 1024;
         boost::log::core::get()->set_filter(boost::log::trivial::severity >= log_severity);
+
+        if (realtime_settings.m_busy_spin && realtime_settings.m_priority > 0)
+        {
+            // It is not pinned (otherwise it is rejected above), but still keeps one of the cores from the other tasks
+            BOOST_LOG_TRIVIAL(warning) << "The input thread busy spins with a real-time priority, starving the other "
+                                          "tasks on whichever core it runs.";
+        }
+
+#if !defined(SDL2DSU_USE_IO_URING)
+        if (network_settings.m_io_uring)
+        {
+            BOOST_LOG_TRIVIAL(warning) << "io_uring support is not compiled in, using the default backend.";
+            network_settings.m_io_uring = false;
+        }
+#endif
+
+#if !defined(__linux__)
+        if (network_settings.m_workers > 1)
+        {
+            BOOST_LOG_TRIVIAL(warning) << "Multiple workers are only supported on Linux, using a single one.";
+            network_settings.m_workers = 1;
+        }
+        if (realtime_settings.m_priority > 0 || !realtime_settings.m_cpus.empty() || realtime_settings.m_lock_memory
+            || realtime_settings.m_prefault_heap_size > 0)
+        {
+            BOOST_LOG_TRIVIAL(warning) << "The real-time options are only supported on Linux, ignoring them.";
+            realtime_settings = shared::RealtimeSettings{.m_busy_spin = realtime_settings.m_busy_spin};
+        }
+#endif
     }
     catch (const std::exception& exception)
     {
@@ -126,7 +311,7 @@ bool interuptable_sleep(int init_delay)
                 finished_sleeping = true;
                 io_context.stop();
             },
-            exceptionHandler);
+            shared::exceptionHandler);
 
         io_context.run();
         if (interrupted || !finished_sleeping)
@@ -147,12 +332,19 @@ int main(int argc, char** argv)
 {
     try
     {
-        int           init_delay;
-        std::uint16_t port;
-        std::regex    controller_name_filter;
-        std::string   mapping_file;
-        bool          sensor_auto_toggle;
-        if (!parseProgramArgs(argc, argv, init_delay, port, controller_name_filter, mapping_file, sensor_auto_toggle))
+        int                       init_delay;
+        std::uint16_t             port;
+        std::regex                controller_name_filter;
+        std::string               mapping_file;
+        bool                      sensor_auto_toggle;
+        std::chrono::milliseconds max_idle_interval;
+        server::NetworkSettings   network_settings;
+        server::ClientSettings    client_settings;
+        server::BroadcastSettings broadcast_settings;
+        shared::RealtimeSettings  realtime_settings;
+        if (!parseProgramArgs(argc, argv, init_delay, port, controller_name_filter, mapping_file, sensor_auto_toggle,
+                              max_idle_interval, network_settings, client_settings, broadcast_settings,
+                              realtime_settings))
         {
             return EXIT_FAILURE;
         }
@@ -162,33 +354,123 @@ int main(int argc, char** argv)
             return EXIT_SUCCESS;
         }
 
-        // Prepare general coroutine stuff
+        // Any memory of the threads is locked as well, so this has to be done before they are started
+        shared::prepareRealtimeMemory(realtime_settings);
+
+        // Prepare server stuff, the SDL input and each of the server workers run on separate threads
+        const auto                   server_id{server::generateServerId()};
+        shared::GamepadDataSnapshots gamepad_data_snapshots;
+
+        // The kernel spreads the clients between the workers (based on their addresses and ports), so are the caps
+        const auto split_between_workers = [&network_settings](std::size_t value)
+        { return (value + network_settings.m_workers - 1) / network_settings.m_workers; };
+        server::ClientSettings worker_client_settings{client_settings};
+        worker_client_settings.m_max_clients             = split_between_workers(client_settings.m_max_clients);
+        worker_client_settings.m_max_clients_per_address = split_between_workers(
+            client_settings.m_max_clients_per_address);
+
+        // The input loop backs off while there are no clients, until the first one shows up on any of the workers
         constexpr int           no_concurrency{1};
-        boost::asio::io_context io_context{no_concurrency};
-        boost::asio::signal_set signals(io_context, SIGINT, SIGTERM);
-        signals.async_wait([&io_context](auto, auto) { io_context.stop(); });
+        boost::asio::io_context input_context{no_concurrency};
+        gamepads::IdleBackoff   idle_backoff{input_context.get_executor(), max_idle_interval};
+
+        if (network_settings.m_workers > 1)
+        {
+            server::ensurePortIsFree(port);
+        }
+
+        std::vector<std::unique_ptr<server::ServerWorker>> workers;
+        for (std::size_t i = 0; i < network_settings.m_workers; ++i)
+        {
+            workers.push_back(std::make_unique<server::ServerWorker>(
+                server_id, port, network_settings.m_workers > 1, gamepad_data_snapshots, network_settings,
+                worker_client_settings, broadcast_settings, [&idle_backoff]() { idle_backoff.wake(); }));
+        }
+
+        const auto stop_all = [&input_context, &workers]()
+        {
+            input_context.stop();
+            for (auto& worker : workers)
+            {
+                worker->stop();
+            }
+        };
 
-        // Prepare server stuff
-        const auto server_id{server::generateServerId()};
-        auto       socket{boost::asio::ip::udp::socket(io_context, {boost::asio::ip::udp::v4(), port})};
+        boost::asio::signal_set signals(workers.front()->getIoContext(), SIGINT, SIGTERM);
+        signals.async_wait([&stop_all](auto, auto) { stop_all(); });
 
         // Prepare coroutine containers
-        server::ActiveClients        active_clients;
-        shared::GamepadDataContainer gamepad_data;
+        shared::GamepadDataContainer gamepad_data;          // Only used by the input thread
+        shared::PortInfoGenerations  port_info_generations;  // Only used by the input thread
+
+        // The callbacks are only referenced by the input loop
+        const auto notify_clients = [&](const std::uint8_t updated_index, shared::UpdatePriority priority)
+        {
+            // The snapshot is published right away, the workers are only woken up to send it
+            gamepad_data_snapshots.publish(updated_index, gamepad_data[updated_index], port_info_generations, priority);
+            for (auto& worker : workers)
+            {
+                worker->notify(updated_index, priority);
+            }
+        };
+        const auto get_number_of_active_clients = [&]()
+        {
+            std::size_t number_of_clients{0};
+            for (const auto& worker : workers)
+            {
+                number_of_clients += worker->getNumberOfClients();
+            }
+            return number_of_clients;
+        };
 
         // Spawn the coroutines
-        boost::asio::co_spawn(io_context, server::listenAndRespond(server_id, gamepad_data, active_clients, socket),
-                              exceptionHandler);
-        boost::asio::co_spawn(
-            io_context,
-            gamepads::enumerateAndWatch(
-                [&](const std::uint8_t updated_index)
-                { return server::distributePadData(server_id, gamepad_data, updated_index, active_clients, socket); },
-                [&]() { return active_clients.getNumberOfClients(); }, controller_name_filter, mapping_file,
-                sensor_auto_toggle, gamepad_data),
-            exceptionHandler);
+        boost::asio::co_spawn(input_context,
+                              gamepads::enumerateAndWatch(notify_clients, get_number_of_active_clients,
+                                                          controller_name_filter, mapping_file, sensor_auto_toggle,
+                                                          realtime_settings.m_busy_spin, idle_backoff, gamepad_data,
+                                                          port_info_generations),
+                              shared::exceptionHandler);
 
-        io_context.run();
+        // The first worker runs on the main thread, once any of the threads stops, all of them are stopped
+        std::vector<std::exception_ptr> exceptions(workers.size() + 1);
+        const auto                      run_and_stop_all =
+            [&stop_all, &realtime_settings](std::size_t thread_index, const std::string& thread_name, auto&& run,
+                                            std::exception_ptr& exception)
+        {
+            try
+            {
+                shared::applyRealtimeScheduling(realtime_settings, thread_index, thread_name);
+                run();
+            }
+            catch (...)
+            {
+                exception = std::current_exception();
+            }
+            stop_all();
+        };
+
+        std::vector<std::thread> threads;
+        threads.emplace_back(run_and_stop_all, 0, "input", [&input_context]() { input_context.run(); },
+                             std::ref(exceptions[0]));
+        for (std::size_t i = 1; i < workers.size(); ++i)
+        {
+            threads.emplace_back(run_and_stop_all, i + 1, "worker " + std::to_string(i),
+                                 [&worker = *workers[i]]() { worker.run(); }, std::ref(exceptions[i + 1]));
+        }
+
+        run_and_stop_all(1, "worker 0", [&worker = *workers.front()]() { worker.run(); }, exceptions[1]);
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        for (const auto& exception : exceptions)
+        {
+            if (exception)
+            {
+                std::rethrow_exception(exception);
+            }
+        }
     }
     catch (const std::exception& exception)
     {
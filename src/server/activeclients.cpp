@@ -2,59 +2,80 @@
 #include "activeclients.h"
 
 // system includes
+#include <algorithm>
+#include <bit>
 #include <boost/log/trivial.hpp>
+#include <optional>
 
 // local includes
 
 //--------------------------------------------------------------------------------------------------
 
-namespace server
+namespace
 {
-using namespace std::chrono_literals;
+// The timeout spans half of the wheel, so that a deadline never wraps around it
+constexpr std::size_t WHEEL_SIZE{64};
+constexpr std::size_t TICKS_PER_TIMEOUT{WHEEL_SIZE / 2};
+}  // namespace
 
 //--------------------------------------------------------------------------------------------------
 
-std::set<ClientEndpointCounter> ActiveClients::getRelevantEndpoints(const std::uint8_t index)
+namespace server
+{
+ActiveClients::ActiveClients(const ClientSettings& settings)
+    : m_max_clients_per_address{settings.m_max_clients_per_address}
+    , m_min_send_interval{settings.m_min_send_interval}
+    , m_timeout{settings.m_timeout}
+    , m_tick_duration{std::max<std::chrono::steady_clock::duration>(m_timeout / TICKS_PER_TIMEOUT,
+                                                                     std::chrono::milliseconds{1})}
+    , m_wheel_start{std::chrono::steady_clock::now()}
+    , m_wheel(WHEEL_SIZE)
 {
-    performLazyCleanup();
+    BOOST_ASSERT(settings.m_max_clients > 0 && settings.m_max_clients < INVALID_INDEX);
 
-    std::set<ClientEndpointCounter> relevant_endpoints;
-    BOOST_ASSERT(index < 4);
-    for (auto& client : m_clients)
+    // The load factor of the hash table is kept at or below 1/2, which keeps the probe sequences short
+    m_table.assign(std::bit_ceil(settings.m_max_clients * 2), INVALID_INDEX);
+    m_clients.resize(settings.m_max_clients);
+    m_free_clients.reserve(settings.m_max_clients);
+    for (auto client_index = static_cast<std::uint32_t>(settings.m_max_clients); client_index > 0; --client_index)
     {
-        auto& client_data{client.second[index]};
-        if (client_data != std::nullopt)
-        {
-            // Note: incrementing counter here
-            relevant_endpoints.insert({client.first, client_data->m_packet_counter++});
-        }
+        m_free_clients.push_back(client_index - 1);
     }
-    return relevant_endpoints;
+
+    for (auto& subscribers : m_subscribers)
+    {
+        subscribers.reserve(settings.m_max_clients);
+    }
+    m_next_pending_times.fill(std::chrono::steady_clock::time_point::max());
 }
 
 //--------------------------------------------------------------------------------------------------
 
 void ActiveClients::updateRequestTime(const boost::asio::ip::udp::endpoint& endpoint, std::uint32_t client_id,
-                                      std::set<std::uint8_t> requested_indexes)
+                                      shared::PadIndexSet requested_indexes)
 {
     const ClientEndpoint client_endpoint{client_id, endpoint};
-    auto                 pad_data_it{m_clients.find(client_endpoint)};
+    const auto           hash{hashValue(client_endpoint)};
+    auto                 client_index{findClient(client_endpoint, hash)};
 
-    if (pad_data_it == std::end(m_clients))
+    if (client_index == INVALID_INDEX)
     {
-        pad_data_it = m_clients.try_emplace(client_endpoint, ClientDataPerPad{}).first;
+        client_index = insertClient(client_endpoint, hash);
     }
 
     const auto now{std::chrono::steady_clock::now()};
-    const auto set_client_data_timestamp = [&now, &endpoint, client_id](std::optional<ClientData>& client_data)
+    m_clients[client_index].m_last_request_time = now;
+
+    const auto set_client_data_timestamp = [this, &now, client_index](std::uint8_t index)
     {
-        if (client_data)
+        const auto position{m_clients[client_index].m_subscriber_positions[index]};
+        if (position != INVALID_INDEX)
         {
-            client_data->m_last_request_time = now;
+            m_subscribers[index][position].m_last_request_time = now;
         }
         else
         {
-            client_data = {now, 0};
+            subscribe(client_index, index, now);
         }
     };
 
@@ -66,67 +87,339 @@ void ActiveClients::updateRequestTime(const boost::asio::ip::udp::endpoint& endp
 
             BOOST_LOG_TRIVIAL(debug) << "Client " << client_id << " (" << endpoint << ") updated timestamp for pad "
                                      << static_cast<int>(index);
-            set_client_data_timestamp(pad_data_it->second[index]);
+            set_client_data_timestamp(index);
         }
     }
     else
     {
         BOOST_LOG_TRIVIAL(debug) << "Client " << client_id << " (" << endpoint << ") updated timestamp for all pads.";
-        for (auto& client_data : pad_data_it->second)
+        for (std::uint8_t index = 0; index < m_subscribers.size(); ++index)
         {
-            set_client_data_timestamp(client_data);
+            set_client_data_timestamp(index);
         }
     }
 }
 
 //--------------------------------------------------------------------------------------------------
 
+void ActiveClients::removeEndpoint(const boost::asio::ip::udp::endpoint& endpoint)
+{
+    // The endpoint can be shared by multiple client ids. This is only done once the endpoint becomes unreachable, so
+    // simply going through all the clients is good enough
+    for (std::uint32_t client_index = 0; client_index < m_clients.size(); ++client_index)
+    {
+        const auto& client{m_clients[client_index]};
+        if (client.m_subscription_count == 0 || client.m_client_endpoint.m_endpoint != endpoint)
+        {
+            continue;
+        }
+
+        BOOST_LOG_TRIVIAL(debug) << "Client " << client.m_client_endpoint.m_client_id << " (" << endpoint
+                                 << ") is unreachable";
+        removeClient(client_index);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
 std::size_t ActiveClients::getNumberOfClients() const
 {
-    performLazyCleanup();
+    return m_number_of_clients.load(std::memory_order_relaxed);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::chrono::steady_clock::time_point ActiveClients::getNextPendingTime() const
+{
+    return *std::min_element(std::begin(m_next_pending_times), std::end(m_next_pending_times));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::chrono::steady_clock::duration ActiveClients::getExpiryInterval() const
+{
+    return m_tick_duration;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void ActiveClients::expireClients(std::chrono::steady_clock::time_point now)
+{
+    const auto last_tick{static_cast<std::uint64_t>((now - m_wheel_start) / m_tick_duration)};
+    if (last_tick >= m_next_tick + WHEEL_SIZE)
+    {
+        // We are running late, but each slot only has to be processed once
+        m_next_tick = last_tick - WHEEL_SIZE + 1;
+    }
+
+    while (m_next_tick <= last_tick)
+    {
+        // The slot is swapped out, since the entries that are not expired yet are rescheduled
+        std::swap(m_expiring_entries, m_wheel[m_next_tick % WHEEL_SIZE]);
+        ++m_next_tick;
+
+        for (const auto& entry : m_expiring_entries)
+        {
+            expireClient(entry, now);
+        }
+        m_expiring_entries.clear();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::uint32_t ActiveClients::findClient(const ClientEndpoint& client_endpoint, std::size_t hash) const
+{
+    if (m_table.empty())
+    {
+        return INVALID_INDEX;
+    }
+
+    const std::size_t mask{m_table.size() - 1};
+    for (std::size_t slot = hash & mask;; slot = (slot + 1) & mask)
+    {
+        const auto client_index{m_table[slot]};
+        if (client_index == INVALID_INDEX)
+        {
+            return INVALID_INDEX;
+        }
+
+        const auto& client{m_clients[client_index]};
+        if (client.m_hash == hash && client.m_client_endpoint == client_endpoint)
+        {
+            return client_index;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::uint32_t ActiveClients::insertClient(const ClientEndpoint& client_endpoint, std::size_t hash)
+{
+    makeRoomForClient(client_endpoint.m_endpoint.address());
+    BOOST_ASSERT(!m_free_clients.empty());
+
+    const auto client_index{m_free_clients.back()};
+    m_free_clients.pop_back();
+
+    auto& client{m_clients[client_index]};
+    client.m_client_endpoint    = client_endpoint;
+    client.m_hash               = hash;
+    client.m_subscription_count = 0;
+    client.m_generation         = client.m_generation + 1;
+    client.m_subscriber_positions.fill(INVALID_INDEX);
+
+    const std::size_t mask{m_table.size() - 1};
+    std::size_t       slot{hash & mask};
+    while (m_table[slot] != INVALID_INDEX)
+    {
+        slot = (slot + 1) & mask;
+    }
+
+    m_table[slot] = client_index;
+    m_number_of_clients.fetch_add(1, std::memory_order_relaxed);
+
+    scheduleExpiry(client_index, std::chrono::steady_clock::now() + m_timeout);
+    return client_index;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void ActiveClients::eraseClient(std::uint32_t client_index)
+{
+    const std::size_t mask{m_table.size() - 1};
+    std::size_t       slot{m_clients[client_index].m_hash & mask};
+    while (m_table[slot] != client_index)
+    {
+        slot = (slot + 1) & mask;
+    }
 
-    return m_clients.size();
+    // Backward shift deletion - the entries following the freed slot are moved closer to their ideal slots, so that
+    // no tombstones are needed
+    m_table[slot] = INVALID_INDEX;
+    for (std::size_t next = (slot + 1) & mask; m_table[next] != INVALID_INDEX; next = (next + 1) & mask)
+    {
+        const std::size_t ideal_slot{m_clients[m_table[next]].m_hash & mask};
+        if (((next - ideal_slot) & mask) >= ((next - slot) & mask))
+        {
+            m_table[slot] = m_table[next];
+            m_table[next] = INVALID_INDEX;
+            slot          = next;
+        }
+    }
+
+    m_free_clients.push_back(client_index);
+    m_number_of_clients.fetch_sub(1, std::memory_order_relaxed);
 }
 
 //--------------------------------------------------------------------------------------------------
 
-void ActiveClients::performLazyCleanup() const
+void ActiveClients::removeClient(std::uint32_t client_index)
 {
-    for (auto it = std::begin(m_clients); it != std::end(m_clients);)
+    for (std::uint8_t index = 0; index < m_subscribers.size(); ++index)
     {
-        auto& pad_data{it->second};
-        for (std::size_t i = 0; i < pad_data.size(); ++i)
+        const auto position{m_clients[client_index].m_subscriber_positions[index]};
+        if (position != INVALID_INDEX)
+        {
+            // Note: the client is erased together with its last subscription
+            unsubscribe(index, position);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void ActiveClients::makeRoomForClient(const boost::asio::ip::address& address)
+{
+    // This is only done for new clients, so simply going through all of them is good enough
+    std::size_t   clients_with_address{0};
+    std::uint32_t oldest_client{INVALID_INDEX};
+    std::uint32_t oldest_client_with_address{INVALID_INDEX};
+    const auto    is_older = [this](std::uint32_t client_index, std::uint32_t other_index)
+    {
+        return other_index == INVALID_INDEX
+               || m_clients[client_index].m_last_request_time < m_clients[other_index].m_last_request_time;
+    };
+
+    for (std::uint32_t client_index = 0; client_index < m_clients.size(); ++client_index)
+    {
+        const auto& client{m_clients[client_index]};
+        if (client.m_subscription_count == 0)
+        {
+            continue;
+        }
+
+        if (is_older(client_index, oldest_client))
         {
-            auto& client_data{pad_data[i]};
-            if (client_data)
+            oldest_client = client_index;
+        }
+
+        if (client.m_client_endpoint.m_endpoint.address() == address)
+        {
+            ++clients_with_address;
+            if (is_older(client_index, oldest_client_with_address))
             {
-                const bool has_timed_out{std::chrono::steady_clock::now() - client_data->m_last_request_time > 5s};
-                if (has_timed_out)
-                {
-                    BOOST_LOG_TRIVIAL(debug) << "Client " << it->first.m_client_id << " (" << it->first.m_endpoint
-                                             << ") has timed out for pad " << static_cast<int>(i);
-                    client_data = std::nullopt;
-                }
+                oldest_client_with_address = client_index;
             }
         }
+    }
+
+    std::uint32_t evicted_client{INVALID_INDEX};
+    if (clients_with_address >= m_max_clients_per_address)
+    {
+        evicted_client = oldest_client_with_address;
+    }
+    else if (m_free_clients.empty())
+    {
+        evicted_client = oldest_client;
+    }
+
+    if (evicted_client != INVALID_INDEX)
+    {
+        const auto& client{m_clients[evicted_client]};
+        BOOST_LOG_TRIVIAL(debug) << "Client " << client.m_client_endpoint.m_client_id << " ("
+                                 << client.m_client_endpoint.m_endpoint << ") is evicted to make room for a new client";
+
+        removeClient(evicted_client);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void ActiveClients::subscribe(std::uint32_t client_index, std::uint8_t index,
+                              std::chrono::steady_clock::time_point now)
+{
+    auto& client{m_clients[client_index]};
+    auto& subscribers{m_subscribers[index]};
 
-        auto valid_client_data_it =
-            std::find_if(std::begin(pad_data), std::end(pad_data),
-                         [](const auto& client_data) { return static_cast<bool>(client_data); });
+    client.m_subscriber_positions[index] = static_cast<std::uint32_t>(subscribers.size());
+    ++client.m_subscription_count;
+    subscribers.push_back({client.m_client_endpoint.m_endpoint, 0, client_index, now});
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void ActiveClients::unsubscribe(std::uint8_t index, std::uint32_t position)
+{
+    auto&      subscribers{m_subscribers[index]};
+    const auto client_index{subscribers[position].m_client_index};
+
+    // The last subscriber takes the place of the removed one to keep the vector dense
+    if (position + 1 != subscribers.size())
+    {
+        subscribers[position] = std::move(subscribers.back());
+        m_clients[subscribers[position].m_client_index].m_subscriber_positions[index] = position;
+    }
+    subscribers.pop_back();
+
+    auto& client{m_clients[client_index]};
+    client.m_subscriber_positions[index] = INVALID_INDEX;
+    if (--client.m_subscription_count == 0)
+    {
+        BOOST_LOG_TRIVIAL(debug) << "Client " << client.m_client_endpoint.m_client_id << " ("
+                                 << client.m_client_endpoint.m_endpoint << ") is no longer connected ";
+
+        // Client no longer has any active requests
+        eraseClient(client_index);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::uint64_t ActiveClients::getTick(std::chrono::steady_clock::time_point time_point) const
+{
+    // Rounding up, so that the slot is never processed before the time point
+    const auto elapsed{time_point - m_wheel_start};
+    return static_cast<std::uint64_t>((elapsed + m_tick_duration - std::chrono::steady_clock::duration{1})
+                                      / m_tick_duration);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void ActiveClients::scheduleExpiry(std::uint32_t client_index, std::chrono::steady_clock::time_point deadline)
+{
+    const auto tick{std::clamp(getTick(deadline), m_next_tick, m_next_tick + WHEEL_SIZE - 1)};
+    m_wheel[tick % WHEEL_SIZE].push_back({client_index, m_clients[client_index].m_generation});
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void ActiveClients::expireClient(const WheelEntry& entry, std::chrono::steady_clock::time_point now)
+{
+    if (m_clients[entry.m_client_index].m_generation != entry.m_generation)
+    {
+        // The client has already been removed
+        return;
+    }
 
-        if (valid_client_data_it != std::end(pad_data))
+    std::optional<std::chrono::steady_clock::time_point> next_deadline;
+    for (std::uint8_t index = 0; index < m_subscribers.size(); ++index)
+    {
+        const auto& client{m_clients[entry.m_client_index]};
+        const auto  position{client.m_subscriber_positions[index]};
+        if (position == INVALID_INDEX)
         {
-            // This that the client is still active
-            ++it;
+            continue;
         }
-        else
-        {
-            BOOST_LOG_TRIVIAL(debug) << "Client " << it->first.m_client_id << " (" << it->first.m_endpoint
-                                     << ") is no longer connected ";
 
-            // Client no longer has any active requests
-            it = m_clients.erase(it);
+        const auto deadline{m_subscribers[index][position].m_last_request_time + m_timeout};
+        if (now < deadline)
+        {
+            next_deadline = std::min(next_deadline.value_or(deadline), deadline);
+            continue;
         }
+
+        BOOST_LOG_TRIVIAL(debug) << "Client " << client.m_client_endpoint.m_client_id << " ("
+                                 << client.m_client_endpoint.m_endpoint << ") has timed out for pad "
+                                 << static_cast<int>(index);
+
+        // Note: the client is removed together with its last subscription
+        unsubscribe(index, position);
+    }
+
+    if (next_deadline)
+    {
+        scheduleExpiry(entry.m_client_index, *next_deadline);
     }
 }
 }  // namespace server
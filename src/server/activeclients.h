@@ -1,41 +1,189 @@
 #pragma once
 
 // system includes
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <boost/assert.hpp>
 #include <boost/move/core.hpp>
 #include <chrono>
-#include <map>
-#include <optional>
-#include <set>
+#include <limits>
+#include <vector>
 
 // local includes
-#include "clientendpointcounter.h"
+#include "clientendpoint.h"
+#include "clientsettings.h"
+#include "shared/padindexset.h"
 
 //--------------------------------------------------------------------------------------------------
 
 namespace server
 {
+// The clients are kept in an open addressing hash table, while the subscriptions of each pad are kept in a dense
+// vector, so that sending out the pad data only has to go through the subscribers of that pad.
+//
+// All the storage is allocated upfront for the maximum number of clients. Once the limit (or the per address limit)
+// is reached, the least recently active client is evicted to make room for the new one.
+//
+// The subscriptions expire via a hashed timing wheel that has to be advanced by calling `expireClients` every
+// `getExpiryInterval`. Each client has a single entry in the wheel, which is only checked (and rescheduled if the
+// client has sent new requests in the meantime) once its slot comes up, so refreshing a subscription is O(1).
+//
+// The pad data sent to each subscriber can be capped at a minimum send interval. A subscriber that is over its rate
+// is only marked as pending, so that it receives the latest data (instead of every intermediate state) once
+// `forEachPendingEndpoint` is called after its next send time.
 class ActiveClients final
 {
     BOOST_MOVABLE_BUT_NOT_COPYABLE(ActiveClients)
 
 public:
-    explicit ActiveClients() = default;
+    explicit ActiveClients(const ClientSettings& settings);
+
+    // Calls `callback(const boost::asio::ip::udp::endpoint&, std::uint32_t packet_counter)` for every subscriber of
+    // the pad that is within its send rate.
+    template<class Callback>
+    void forEachRelevantEndpoint(const std::uint8_t index, std::chrono::steady_clock::time_point now,
+                                 Callback&& callback);
+    // Same as `forEachRelevantEndpoint`, but only for the pending subscribers whose next send time has come.
+    template<class Callback>
+    void forEachPendingEndpoint(const std::uint8_t index, std::chrono::steady_clock::time_point now,
+                                Callback&& callback);
+    std::chrono::steady_clock::time_point getNextPendingTime() const;
 
-    std::set<ClientEndpointCounter> getRelevantEndpoints(const std::uint8_t index);
     void        updateRequestTime(const boost::asio::ip::udp::endpoint& endpoint, std::uint32_t client_id,
-                                  std::set<std::uint8_t> requested_indexes);
-    std::size_t getNumberOfClients() const;
+                                  shared::PadIndexSet requested_indexes);
+    void        removeEndpoint(const boost::asio::ip::udp::endpoint& endpoint);
+    std::size_t getNumberOfClients() const;  // Note: can be called from any thread
+
+    std::chrono::steady_clock::duration getExpiryInterval() const;
+    void                                expireClients(std::chrono::steady_clock::time_point now);
 
 private:
-    void performLazyCleanup() const;
+    static constexpr std::uint32_t INVALID_INDEX{std::numeric_limits<std::uint32_t>::max()};
 
-    struct ClientData
+    struct Client
     {
+        ClientEndpoint                        m_client_endpoint;
+        std::size_t                           m_hash;
+        std::array<std::uint32_t, 4>          m_subscriber_positions;
+        std::uint32_t                         m_subscription_count;
+        std::uint32_t                         m_generation;  // Changes when the entry is reused for another client
         std::chrono::steady_clock::time_point m_last_request_time;
-        std::uint32_t                         m_packet_counter{0};
     };
 
-    using ClientDataPerPad = std::array<std::optional<ClientData>, 4>;
-    mutable std::map<ClientEndpoint, ClientDataPerPad> m_clients;
+    struct Subscriber
+    {
+        boost::asio::ip::udp::endpoint        m_endpoint;
+        std::uint32_t                         m_packet_counter;
+        std::uint32_t                         m_client_index;
+        std::chrono::steady_clock::time_point m_last_request_time;
+        std::chrono::steady_clock::time_point m_next_send_time{};
+        bool                                  m_pending{false};
+    };
+
+    template<class Callback>
+    void sendToSubscriber(Subscriber& subscriber, std::chrono::steady_clock::time_point now, Callback& callback);
+
+    std::uint32_t findClient(const ClientEndpoint& client_endpoint, std::size_t hash) const;
+    std::uint32_t insertClient(const ClientEndpoint& client_endpoint, std::size_t hash);
+    void          eraseClient(std::uint32_t client_index);
+    void          removeClient(std::uint32_t client_index);
+    void          makeRoomForClient(const boost::asio::ip::address& address);
+
+    struct WheelEntry
+    {
+        std::uint32_t m_client_index;
+        std::uint32_t m_generation;
+    };
+
+    std::uint64_t getTick(std::chrono::steady_clock::time_point time_point) const;
+    void          scheduleExpiry(std::uint32_t client_index, std::chrono::steady_clock::time_point deadline);
+    void          expireClient(const WheelEntry& entry, std::chrono::steady_clock::time_point now);
+
+    void subscribe(std::uint32_t client_index, std::uint8_t index, std::chrono::steady_clock::time_point now);
+    void unsubscribe(std::uint8_t index, std::uint32_t position);
+
+    // Slots of the hash table hold the indexes into `m_clients`, which stay stable while the table is rearranged
+    std::vector<std::uint32_t>             m_table;
+    std::vector<Client>                    m_clients;
+    std::vector<std::uint32_t>             m_free_clients;
+    std::atomic<std::size_t>               m_number_of_clients{0};  // Also read by the input thread
+    std::array<std::vector<Subscriber>, 4> m_subscribers;
+    std::size_t                            m_max_clients_per_address;
+
+    std::chrono::steady_clock::duration                  m_min_send_interval;
+    std::array<std::chrono::steady_clock::time_point, 4> m_next_pending_times;
+
+    std::chrono::steady_clock::duration   m_timeout;
+    std::chrono::steady_clock::duration   m_tick_duration;
+    std::chrono::steady_clock::time_point m_wheel_start;
+    std::uint64_t                         m_next_tick{0};
+    std::vector<std::vector<WheelEntry>>  m_wheel;
+    std::vector<WheelEntry>               m_expiring_entries;
 };
+
+//--------------------------------------------------------------------------------------------------
+
+template<class Callback>
+void ActiveClients::forEachRelevantEndpoint(const std::uint8_t index, std::chrono::steady_clock::time_point now,
+                                            Callback&& callback)
+{
+    BOOST_ASSERT(index < 4);
+    for (auto& subscriber : m_subscribers[index])
+    {
+        if (now < subscriber.m_next_send_time)
+        {
+            subscriber.m_pending        = true;
+            m_next_pending_times[index] = std::min(m_next_pending_times[index], subscriber.m_next_send_time);
+            continue;
+        }
+
+        sendToSubscriber(subscriber, now, callback);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+template<class Callback>
+void ActiveClients::forEachPendingEndpoint(const std::uint8_t index, std::chrono::steady_clock::time_point now,
+                                           Callback&& callback)
+{
+    BOOST_ASSERT(index < 4);
+    if (now < m_next_pending_times[index])
+    {
+        return;
+    }
+
+    m_next_pending_times[index] = std::chrono::steady_clock::time_point::max();
+    for (auto& subscriber : m_subscribers[index])
+    {
+        if (!subscriber.m_pending)
+        {
+            continue;
+        }
+
+        if (now < subscriber.m_next_send_time)
+        {
+            m_next_pending_times[index] = std::min(m_next_pending_times[index], subscriber.m_next_send_time);
+            continue;
+        }
+
+        sendToSubscriber(subscriber, now, callback);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+template<class Callback>
+void ActiveClients::sendToSubscriber(Subscriber& subscriber, std::chrono::steady_clock::time_point now,
+                                     Callback& callback)
+{
+    // The cadence is kept while the subscriber is being throttled, but an idle subscriber does not build up a burst
+    const auto next_send_time{subscriber.m_next_send_time + m_min_send_interval};
+    subscriber.m_next_send_time = now < next_send_time ? next_send_time : now + m_min_send_interval;
+    subscriber.m_pending        = false;
+
+    // Note: incrementing counter here
+    callback(subscriber.m_endpoint, subscriber.m_packet_counter++);
+}
 }  // namespace server
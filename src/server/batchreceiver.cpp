@@ -0,0 +1,341 @@
+// class header include
+#include "batchreceiver.h"
+
+// system includes
+#include <boost/log/trivial.hpp>
+#include <cerrno>
+#include <cstring>
+
+// local includes
+#include "shared/coroutines.h"
+#include "unreachableclients.h"
+
+//--------------------------------------------------------------------------------------------------
+
+namespace
+{
+#if defined(SDL2DSU_USE_IO_URING)
+constexpr unsigned int  BUFFER_RING_ENTRIES{2 * server::BatchReceiver::MAX_BATCH_SIZE};
+constexpr unsigned int  IO_URING_ENTRIES{BUFFER_RING_ENTRIES};  // CQ is twice as big, so all buffers fit into it
+constexpr std::uint16_t BUFFER_GROUP_ID{0};
+const std::size_t       NAME_SIZE{boost::asio::ip::udp::endpoint{}.capacity()};
+const std::size_t       BUFFER_SIZE{sizeof(io_uring_recvmsg_out) + NAME_SIZE
+                                    + server::BatchReceiver::MAX_DATAGRAM_SIZE};
+#endif
+}  // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+namespace server
+{
+BatchReceiver::BatchReceiver(boost::asio::ip::udp::socket& socket, [[maybe_unused]] const NetworkSettings& settings)
+    : m_socket{socket}
+    , m_buffers(MAX_BATCH_SIZE)
+    , m_datagrams(MAX_BATCH_SIZE)
+{
+#if defined(SDL2DSU_USE_IO_URING)
+    if (settings.m_io_uring)
+    {
+        try
+        {
+            m_io_uring.emplace(m_socket.get_executor(), IO_URING_ENTRIES);
+            m_buffer_ring = &m_io_uring->createBufferRing(BUFFER_RING_ENTRIES, BUFFER_GROUP_ID);
+            m_ring_storage.resize(BUFFER_RING_ENTRIES * BUFFER_SIZE);
+            m_buffers_in_use.reserve(BUFFER_RING_ENTRIES);
+            for (std::uint16_t i = 0; i < BUFFER_RING_ENTRIES; ++i)
+            {
+                m_buffers_in_use.push_back(i);
+            }
+            returnBuffers();
+
+            m_receive_header.msg_namelen = static_cast<socklen_t>(NAME_SIZE);
+        }
+        catch (const std::exception& exception)
+        {
+            m_io_uring.reset();
+            BOOST_LOG_TRIVIAL(warning)
+                << "Failed to set up io_uring for receiving, falling back to the default backend: "
+                << exception.what();
+        }
+    }
+#endif
+
+    // The default backend is also set up with io_uring, since it takes over if io_uring fails later on
+#if defined(__linux__)
+    m_headers.resize(MAX_BATCH_SIZE);
+    m_iovecs.resize(MAX_BATCH_SIZE);
+    for (std::size_t i = 0; i < MAX_BATCH_SIZE; ++i)
+    {
+        m_iovecs[i].iov_base = m_buffers[i].data();
+        m_iovecs[i].iov_len  = m_buffers[i].size();
+    }
+#else
+    m_socket.non_blocking(true);
+    m_unreachable_endpoints.reserve(MAX_BATCH_SIZE);
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+
+boost::asio::awaitable<std::span<const BatchReceiver::Datagram>> BatchReceiver::receive()
+{
+#if defined(SDL2DSU_USE_IO_URING)
+    if (m_io_uring)
+    {
+        const auto received{co_await receiveWithIoUring()};
+        if (received > 0)
+        {
+            co_return std::span<const Datagram>{m_datagrams.data(), received};
+        }
+
+        // Nothing is received only once io_uring has failed and was dropped, the default backend takes over
+    }
+#endif
+
+#if !defined(__linux__)
+    m_unreachable_endpoints.clear();
+#endif
+
+    for (;;)
+    {
+        const auto [wait_error] =
+            co_await m_socket.async_wait(boost::asio::ip::udp::socket::wait_read, shared::use_nothrow_awaitable);
+        if (wait_error)
+        {
+            BOOST_LOG_TRIVIAL(error) << "BatchReceiver::async_wait: [" << wait_error << "] " << wait_error.message();
+            continue;
+        }
+
+#if defined(__linux__)
+        for (std::size_t i = 0; i < MAX_BATCH_SIZE; ++i)
+        {
+            auto& header{m_headers[i]};
+            auto& endpoint{m_datagrams[i].m_endpoint};
+
+            header = {};
+
+            header.msg_hdr.msg_name    = endpoint.data();
+            header.msg_hdr.msg_namelen = static_cast<socklen_t>(endpoint.capacity());
+            header.msg_hdr.msg_iov     = &m_iovecs[i];
+            header.msg_hdr.msg_iovlen  = 1;
+        }
+
+        const int result{::recvmmsg(m_socket.native_handle(), m_headers.data(),
+                                    static_cast<unsigned int>(m_headers.size()), MSG_DONTWAIT, nullptr)};
+        if (result < 0)
+        {
+            const boost::system::error_code receive_error{errno, boost::system::system_category()};
+            // The unreachable errors are the pending ICMP errors of the sent datagrams, handled via the error queue
+            if (receive_error != boost::asio::error::would_block && receive_error != boost::asio::error::try_again
+                && receive_error != boost::asio::error::interrupted && !isUnreachableError(receive_error))
+            {
+                BOOST_LOG_TRIVIAL(error) << "BatchReceiver::recvmmsg: [" << receive_error << "] "
+                                         << receive_error.message();
+            }
+            continue;
+        }
+
+        const auto received{static_cast<std::size_t>(result)};
+        for (std::size_t i = 0; i < received; ++i)
+        {
+            auto& datagram{m_datagrams[i]};
+            datagram.m_endpoint.resize(m_headers[i].msg_hdr.msg_namelen);
+            datagram.m_data = {m_buffers[i].data(), std::min<std::size_t>(m_headers[i].msg_len, MAX_DATAGRAM_SIZE)};
+        }
+#else
+        std::size_t received{0};
+        while (received < MAX_BATCH_SIZE)
+        {
+            auto&                     datagram{m_datagrams[received]};
+            boost::system::error_code receive_error;
+            datagram.m_endpoint = {};
+            const auto data_size{m_socket.receive_from(boost::asio::buffer(m_buffers[received]), datagram.m_endpoint,
+                                                       0, receive_error)};
+            if (receive_error)
+            {
+                if (isUnreachableError(receive_error))
+                {
+                    // The ICMP error of an earlier datagram, with its destination reported as the sender (if at all)
+                    if (datagram.m_endpoint.port() != 0 && m_unreachable_endpoints.size() < MAX_BATCH_SIZE)
+                    {
+                        m_unreachable_endpoints.push_back(datagram.m_endpoint);
+                        continue;
+                    }
+                    break;
+                }
+
+                if (receive_error != boost::asio::error::would_block && receive_error != boost::asio::error::try_again)
+                {
+                    BOOST_LOG_TRIVIAL(error) << "BatchReceiver::receive_from: [" << receive_error << "] "
+                                             << receive_error.message();
+                }
+                break;
+            }
+
+            datagram.m_data = {m_buffers[received].data(), data_size};
+            ++received;
+        }
+
+        if (!m_unreachable_endpoints.empty())
+        {
+            co_return std::span<const Datagram>{m_datagrams.data(), received};
+        }
+#endif
+
+        if (received > 0)
+        {
+            co_return std::span<const Datagram>{m_datagrams.data(), received};
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::span<const boost::asio::ip::udp::endpoint> BatchReceiver::getUnreachableEndpoints() const
+{
+#if defined(__linux__)
+    return {};
+#else
+    return m_unreachable_endpoints;
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+
+#if defined(SDL2DSU_USE_IO_URING)
+bool BatchReceiver::isUsingIoUring() const
+{
+    return m_io_uring.has_value();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+boost::system::error_code BatchReceiver::armMultishotReceive()
+{
+    io_uring_sqe* const sqe{m_io_uring->tryGetSqe()};
+    BOOST_ASSERT(sqe);
+
+    sqe->opcode    = IORING_OP_RECVMSG;
+    sqe->fd        = m_socket.native_handle();
+    sqe->addr      = reinterpret_cast<std::uint64_t>(&m_receive_header);
+    sqe->len       = 1;
+    sqe->ioprio    = IORING_RECV_MULTISHOT;
+    sqe->flags     = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP_ID;
+
+    boost::system::error_code submit_error;
+    m_multishot_armed = m_io_uring->submit(submit_error) > 0;
+    return submit_error;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void BatchReceiver::returnBuffers()
+{
+    if (m_buffers_in_use.empty())
+    {
+        return;
+    }
+
+    // Note: `io_uring_buf_ring::bufs` cannot be used from C++, because the empty struct that the kernel headers
+    // use to declare the flexible array has a non-zero size here and shifts the entries
+    io_uring_buf* const            buffers{reinterpret_cast<io_uring_buf*>(m_buffer_ring)};
+    constexpr unsigned int         mask{BUFFER_RING_ENTRIES - 1};
+    std::atomic_ref<std::uint16_t> ring_tail{m_buffer_ring->tail};
+    std::uint16_t                  tail{ring_tail.load(std::memory_order_relaxed)};
+    for (const auto buffer_id : m_buffers_in_use)
+    {
+        auto& buffer{buffers[tail & mask]};
+        buffer.addr = reinterpret_cast<std::uint64_t>(m_ring_storage.data() + buffer_id * BUFFER_SIZE);
+        buffer.len  = static_cast<std::uint32_t>(BUFFER_SIZE);
+        buffer.bid  = buffer_id;
+        ++tail;
+    }
+    ring_tail.store(tail, std::memory_order_release);
+
+    m_buffers_in_use.clear();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+boost::asio::awaitable<std::size_t> BatchReceiver::receiveWithIoUring()
+{
+    // The buffers handed out by the previous call are no longer in use
+    returnBuffers();
+
+    for (;;)
+    {
+        if (!m_multishot_armed)
+        {
+            // With an overflowed completion queue the receive is armed again once the completions are consumed,
+            // otherwise there would be nothing to wait for
+            const auto submit_error{armMultishotReceive()};
+            if (submit_error && submit_error != boost::system::errc::device_or_resource_busy)
+            {
+                BOOST_LOG_TRIVIAL(warning)
+                    << "Failed to arm the io_uring receive, falling back to the default backend: [" << submit_error
+                    << "] " << submit_error.message();
+                m_buffer_ring = nullptr;
+                m_io_uring.reset();
+                co_return 0;
+            }
+        }
+
+        co_await m_io_uring->waitForCompletions();
+
+        std::size_t received{0};
+        m_io_uring->consumeCompletions(
+            [this, &received](const io_uring_cqe& cqe)
+            {
+                if ((cqe.flags & IORING_CQE_F_MORE) == 0)
+                {
+                    // The kernel has stopped receiving (e.g. ran out of buffers), it needs to be re-armed
+                    m_multishot_armed = false;
+                }
+
+                if (cqe.res < 0)
+                {
+                    const boost::system::error_code receive_error{-cqe.res, boost::system::system_category()};
+                    if (cqe.res != -ENOBUFS && !isUnreachableError(receive_error))
+                    {
+                        BOOST_LOG_TRIVIAL(error) << "BatchReceiver::io_uring_recvmsg: [" << receive_error << "] "
+                                                 << receive_error.message();
+                    }
+                    return;
+                }
+
+                if ((cqe.flags & IORING_CQE_F_BUFFER) == 0)
+                {
+                    return;
+                }
+
+                const auto buffer_id{static_cast<std::uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT)};
+                m_buffers_in_use.push_back(buffer_id);
+
+                // Buffer layout: io_uring_recvmsg_out | name | control | payload
+                const std::uint8_t* const buffer{m_ring_storage.data() + buffer_id * BUFFER_SIZE};
+                io_uring_recvmsg_out      header;
+                std::memcpy(&header, buffer, sizeof(header));
+
+                const std::size_t name_offset{sizeof(header)};
+                const std::size_t name_size{std::min<std::size_t>(header.namelen, NAME_SIZE)};
+                const std::size_t payload_offset{name_offset + m_receive_header.msg_namelen
+                                                 + m_receive_header.msg_controllen};
+                const std::size_t payload_size{
+                    std::min<std::size_t>(header.payloadlen, static_cast<std::size_t>(cqe.res) - payload_offset)};
+
+                auto& datagram{m_datagrams[received++]};
+                std::memcpy(datagram.m_endpoint.data(), buffer + name_offset, name_size);
+                datagram.m_endpoint.resize(name_size);
+                datagram.m_data = {buffer + payload_offset, payload_size};
+            },
+            MAX_BATCH_SIZE);
+
+        if (received > 0)
+        {
+            co_return received;
+        }
+    }
+}
+#endif
+}  // namespace server
@@ -0,0 +1,89 @@
+#pragma once
+
+// system includes
+#include <array>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/move/core.hpp>
+#include <optional>
+#include <span>
+#include <vector>
+
+#if defined(__linux__)
+    #include <sys/socket.h>
+#endif
+
+// local includes
+#include "networksettings.h"
+
+#if defined(SDL2DSU_USE_IO_URING)
+    #include "iouring.h"
+#endif
+
+//--------------------------------------------------------------------------------------------------
+
+namespace server
+{
+// Drains as many pending datagrams as possible (up to `MAX_BATCH_SIZE`) per wakeup into a preallocated set
+// of buffers. On Linux this is a single `recvmmsg` call, while other platforms read the datagrams one by one
+// using non-blocking reads.
+//
+// With the io_uring backend (Linux only, opt-in at build time), a single multishot `recvmsg` keeps receiving
+// into a ring of provided buffers and the datagrams are collected from the completion queue instead.
+class BatchReceiver final
+{
+    BOOST_MOVABLE_BUT_NOT_COPYABLE(BatchReceiver)
+
+public:
+    static constexpr std::size_t MAX_BATCH_SIZE{64};
+    static constexpr std::size_t MAX_DATAGRAM_SIZE{1024};
+
+    struct Datagram
+    {
+        boost::asio::ip::udp::endpoint m_endpoint;
+        std::span<const std::uint8_t>  m_data;
+    };
+
+    explicit BatchReceiver(boost::asio::ip::udp::socket& socket, const NetworkSettings& settings);
+
+    // Note: the returned datagrams are only valid until the next call. There might be none, if only unreachable
+    // endpoints were reported.
+    boost::asio::awaitable<std::span<const Datagram>> receive();
+
+    // The endpoints that the last `receive` call has reported to be unreachable. Only used where the ICMP errors can
+    // not be read from the socket error queue (see `evictUnreachableClients`), so it is always empty on Linux.
+    std::span<const boost::asio::ip::udp::endpoint> getUnreachableEndpoints() const;
+
+#if defined(SDL2DSU_USE_IO_URING)
+    // Whether the datagrams are received via io_uring, i.e. it could be set up and has not failed since
+    bool isUsingIoUring() const;
+#endif
+
+private:
+    using Buffer = std::array<std::uint8_t, MAX_DATAGRAM_SIZE>;
+
+    boost::asio::ip::udp::socket& m_socket;
+    std::vector<Buffer>           m_buffers;
+    std::vector<Datagram>         m_datagrams;
+
+#if defined(__linux__)
+    std::vector<mmsghdr> m_headers;
+    std::vector<iovec>   m_iovecs;
+#else
+    std::vector<boost::asio::ip::udp::endpoint> m_unreachable_endpoints;
+#endif
+
+#if defined(SDL2DSU_USE_IO_URING)
+    boost::system::error_code           armMultishotReceive();
+    void                                returnBuffers();
+    boost::asio::awaitable<std::size_t> receiveWithIoUring();
+
+    std::optional<IoUring>     m_io_uring;
+    io_uring_buf_ring*         m_buffer_ring{nullptr};
+    std::vector<std::uint8_t>  m_ring_storage;
+    std::vector<std::uint16_t> m_buffers_in_use;
+    msghdr                     m_receive_header{};
+    bool                       m_multishot_armed{false};
+#endif
+};
+}  // namespace server
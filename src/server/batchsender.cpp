@@ -0,0 +1,358 @@
+// class header include
+#include "batchsender.h"
+
+// system includes
+#include <boost/log/trivial.hpp>
+#include <cerrno>
+#include <cstring>
+
+#if defined(__linux__)
+    #include <netinet/in.h>
+    #include <netinet/udp.h>
+#endif
+
+// local includes
+#include "shared/coroutines.h"
+#include "unreachableclients.h"
+
+//--------------------------------------------------------------------------------------------------
+
+namespace
+{
+#if defined(__linux__)
+constexpr std::size_t MAX_SEGMENTS{64};
+constexpr std::size_t MAX_SEGMENTED_PAYLOAD{65507};
+
+//--------------------------------------------------------------------------------------------------
+
+bool isSegmentationOffloadError(const mmsghdr& header, const boost::system::error_code& error)
+{
+    if (header.msg_hdr.msg_controllen == 0)
+    {
+        return false;
+    }
+
+    // Older kernels, or devices without checksum offload, reject the `UDP_SEGMENT` control message
+    return error == boost::asio::error::invalid_argument || error == boost::asio::error::operation_not_supported
+           || error == boost::asio::error::no_protocol_option
+           || error == boost::system::error_code{EIO, boost::system::system_category()};
+}
+#endif
+
+#if defined(SDL2DSU_USE_IO_URING)
+constexpr unsigned int IO_URING_ENTRIES{256};
+#endif
+}  // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+namespace server
+{
+BatchSender::BatchSender(boost::asio::ip::udp::socket& socket, const NetworkSettings& settings)
+    : m_socket{socket}
+#if defined(__linux__)
+    , m_segmentation_offload{settings.m_segmentation_offload}
+#endif
+{
+#if !defined(__linux__)
+    if (settings.m_segmentation_offload)
+    {
+        BOOST_LOG_TRIVIAL(warning) << "UDP segmentation offload is not supported on this platform.";
+    }
+#endif
+
+#if defined(SDL2DSU_USE_IO_URING)
+    if (settings.m_io_uring)
+    {
+        try
+        {
+            m_io_uring.emplace(m_socket.get_executor(), IO_URING_ENTRIES);
+        }
+        catch (const std::exception& exception)
+        {
+            BOOST_LOG_TRIVIAL(warning) << "Failed to set up io_uring for sending, falling back to the default backend: "
+                                       << exception.what();
+        }
+    }
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::span<std::uint8_t> BatchSender::queue(const boost::asio::ip::udp::endpoint& endpoint, std::size_t size)
+{
+    BOOST_ASSERT(size > 0 && size <= MAX_PACKET_SIZE);
+    if (m_queued_packets == m_packets.size())
+    {
+        m_packets.emplace_back();
+    }
+
+    auto& packet{m_packets[m_queued_packets++]};
+    packet.m_endpoint = endpoint;
+    packet.m_size     = size;
+    return {packet.m_data.data(), size};
+}
+
+//--------------------------------------------------------------------------------------------------
+
+boost::asio::awaitable<void> BatchSender::flush()
+{
+    if (m_queued_packets == 0)
+    {
+        co_return;
+    }
+
+#if defined(__linux__)
+    std::size_t offset{0};
+    #if defined(SDL2DSU_USE_IO_URING)
+    if (m_io_uring)
+    {
+        // The messages that could not be submitted to io_uring are sent with `sendmmsg` instead
+        offset = co_await flushWithIoUring();
+    }
+    else
+    {
+        prepareHeaders(0);
+    }
+    #else
+    prepareHeaders(0);
+    #endif
+
+    std::size_t retried_offset{m_headers.size()};
+    while (offset < m_headers.size())
+    {
+        const int result{::sendmmsg(m_socket.native_handle(), m_headers.data() + offset,
+                                    static_cast<unsigned int>(m_headers.size() - offset), MSG_DONTWAIT)};
+        if (result >= 0)
+        {
+            // Partial send - the remaining messages are retried from where the kernel stopped
+            offset += static_cast<std::size_t>(result);
+            continue;
+        }
+
+        const boost::system::error_code send_error{errno, boost::system::system_category()};
+        if (send_error == boost::asio::error::interrupted)
+        {
+            continue;
+        }
+
+        if (send_error == boost::asio::error::would_block || send_error == boost::asio::error::try_again)
+        {
+            const auto [wait_error] =
+                co_await m_socket.async_wait(boost::asio::ip::udp::socket::wait_write, shared::use_nothrow_awaitable);
+            if (wait_error)
+            {
+                BOOST_LOG_TRIVIAL(error) << "BatchSender::async_wait: [" << wait_error << "] " << wait_error.message();
+                break;
+            }
+            continue;
+        }
+
+        const auto first_packet{m_header_packets[offset]};
+        if (isSegmentationOffloadError(m_headers[offset], send_error))
+        {
+            BOOST_LOG_TRIVIAL(warning) << "UDP segmentation offload was rejected, falling back to regular sends: ["
+                                       << send_error << "] " << send_error.message();
+
+            m_segmentation_offload = false;
+            prepareHeaders(first_packet);
+            offset = 0;
+            continue;
+        }
+
+        if (isUnreachableError(send_error) && retried_offset != offset)
+        {
+            // Most likely the pending ICMP error of an earlier datagram (it is handled via the error queue), which
+            // the kernel reports once and does not belong to this message
+            retried_offset = offset;
+            continue;
+        }
+
+        // `sendmmsg` only reports an error when the very first message of the batch fails, so the error
+        // belongs to that message and we can skip over it
+        BOOST_LOG_TRIVIAL(error) << "BatchSender::sendmmsg (" << m_packets[first_packet].m_endpoint << "): ["
+                                 << send_error << "] " << send_error.message();
+        ++offset;
+    }
+#else
+    for (std::size_t i = 0; i < m_queued_packets; ++i)
+    {
+        const auto& packet{m_packets[i]};
+        const auto& endpoint{packet.m_endpoint};
+        const auto [send_error, sent_size] = co_await m_socket.async_send_to(
+            boost::asio::buffer(packet.m_data.data(), packet.m_size), endpoint, shared::use_nothrow_awaitable);
+        if (send_error)
+        {
+            BOOST_LOG_TRIVIAL(error) << "BatchSender::async_send_to (sent " << sent_size << " bytes, " << endpoint
+                                     << "): [" << send_error << "] " << send_error.message();
+            continue;
+        }
+    }
+#endif
+
+    m_queued_packets = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+#if defined(__linux__)
+void BatchSender::prepareHeaders(std::size_t first_packet)
+{
+    // Headers are rebuilt for every flush, but the storage is reused
+    m_headers.clear();
+    m_header_packets.clear();
+    m_iovecs.resize(m_queued_packets);
+    m_controls.resize(m_queued_packets);
+
+    std::size_t packet_index{first_packet};
+    while (packet_index < m_queued_packets)
+    {
+        const auto& packet{m_packets[packet_index]};
+        const auto  segment_size{packet.m_size};
+
+        // Merge the following packets that can be segmented by the kernel, since they are going to the same
+        // endpoint and have the same size
+        std::size_t segments{1};
+        while (m_segmentation_offload && packet_index + segments < m_queued_packets && segments < MAX_SEGMENTS
+               && (segments + 1) * segment_size <= MAX_SEGMENTED_PAYLOAD)
+        {
+            const auto& next_packet{m_packets[packet_index + segments]};
+            if (next_packet.m_endpoint != packet.m_endpoint || next_packet.m_size != segment_size)
+            {
+                break;
+            }
+            ++segments;
+        }
+
+        for (std::size_t i = packet_index; i < packet_index + segments; ++i)
+        {
+            m_iovecs[i].iov_base = m_packets[i].m_data.data();
+            m_iovecs[i].iov_len  = m_packets[i].m_size;
+        }
+
+        mmsghdr header{};
+        header.msg_hdr.msg_name    = const_cast<sockaddr*>(packet.m_endpoint.data());
+        header.msg_hdr.msg_namelen = static_cast<socklen_t>(packet.m_endpoint.size());
+        header.msg_hdr.msg_iov     = &m_iovecs[packet_index];
+        header.msg_hdr.msg_iovlen  = segments;
+
+        if (segments > 1)
+        {
+            auto& control{m_controls[packet_index]};
+            header.msg_hdr.msg_control    = control.m_data.data();
+            header.msg_hdr.msg_controllen = control.m_data.size();
+
+            cmsghdr* const control_header{CMSG_FIRSTHDR(&header.msg_hdr)};
+            control_header->cmsg_level = IPPROTO_UDP;
+            control_header->cmsg_type  = UDP_SEGMENT;
+            control_header->cmsg_len   = CMSG_LEN(sizeof(std::uint16_t));
+
+            const auto gso_size{static_cast<std::uint16_t>(segment_size)};
+            std::memcpy(CMSG_DATA(control_header), &gso_size, sizeof(gso_size));
+        }
+
+        m_headers.push_back(header);
+        m_header_packets.push_back(packet_index);
+        packet_index += segments;
+    }
+}
+#endif
+
+//--------------------------------------------------------------------------------------------------
+
+#if defined(SDL2DSU_USE_IO_URING)
+bool BatchSender::isUsingIoUring() const
+{
+    return m_io_uring.has_value();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+boost::asio::awaitable<std::size_t> BatchSender::flushWithIoUring()
+{
+    BOOST_ASSERT(m_io_uring);
+    prepareHeaders(0);
+
+    // The whole batch is submitted at once, unless it does not fit into the submission queue
+    std::size_t prepared{0};
+    std::size_t submitted{0};
+    std::size_t completed{0};
+    std::size_t end{m_headers.size()};
+    while (completed < end)
+    {
+        while (prepared < end)
+        {
+            io_uring_sqe* const sqe{m_io_uring->tryGetSqe()};
+            if (sqe == nullptr)
+            {
+                break;
+            }
+
+            sqe->opcode    = IORING_OP_SENDMSG;
+            sqe->fd        = m_socket.native_handle();
+            sqe->addr      = reinterpret_cast<std::uint64_t>(&m_headers[prepared].msg_hdr);
+            sqe->len       = 1;
+            sqe->user_data = prepared;
+            ++prepared;
+        }
+
+        boost::system::error_code submit_error;
+        submitted += m_io_uring->submit(submit_error);
+        if (submit_error)
+        {
+            // The entries that were not taken have been dropped, so they are prepared again
+            prepared = submitted;
+
+            // Unless the completions that are in flight make room for them, the rest of the batch is left to the
+            // caller, but only once the messages in flight are done with the headers
+            if (submit_error != boost::system::errc::device_or_resource_busy || submitted == completed)
+            {
+                BOOST_LOG_TRIVIAL(error) << "BatchSender::io_uring_enter: [" << submit_error << "] "
+                                         << submit_error.message();
+                end = submitted;
+            }
+        }
+
+        if (completed == submitted)
+        {
+            continue;
+        }
+
+        co_await m_io_uring->waitForCompletions();
+        completed += m_io_uring->consumeCompletions(
+            [this](const io_uring_cqe& cqe)
+            {
+                if (cqe.res >= 0)
+                {
+                    return;
+                }
+
+                const auto&                     header{m_headers[cqe.user_data]};
+                const boost::system::error_code send_error{-cqe.res, boost::system::system_category()};
+                if (isSegmentationOffloadError(header, send_error))
+                {
+                    // Unlike with `sendmmsg`, the other messages are already in flight, so the packets of this
+                    // message are dropped and only the next flush is going to use regular sends
+                    BOOST_LOG_TRIVIAL(warning) << "UDP segmentation offload was rejected: [" << send_error << "] "
+                                               << send_error.message();
+                    m_segmentation_offload = false;
+                    return;
+                }
+
+                if (isUnreachableError(send_error))
+                {
+                    // Most likely the pending ICMP error of an earlier datagram, which is handled via the error queue.
+                    // The packets of this message are dropped, just like a lost datagram.
+                    return;
+                }
+
+                BOOST_LOG_TRIVIAL(error) << "BatchSender::io_uring_sendmsg ("
+                                         << m_packets[m_header_packets[cqe.user_data]].m_endpoint << "): ["
+                                         << send_error << "] " << send_error.message();
+            });
+    }
+
+    co_return end;
+}
+#endif
+}  // namespace server
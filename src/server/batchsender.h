@@ -0,0 +1,106 @@
+#pragma once
+
+// system includes
+#include <array>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/move/core.hpp>
+#include <optional>
+#include <span>
+#include <vector>
+
+#if defined(__linux__)
+    #include <sys/socket.h>
+#endif
+
+// local includes
+#include "networksettings.h"
+#include "serialiser.h"
+
+#if defined(SDL2DSU_USE_IO_URING)
+    #include "iouring.h"
+#endif
+
+//--------------------------------------------------------------------------------------------------
+
+namespace server
+{
+// Collects outgoing datagrams and submits them with as few syscalls as possible. On Linux the whole batch
+// is handed over to `sendmmsg`, while other platforms fall back to sending the packets one by one.
+//
+// With segmentation offload enabled (Linux only), consecutive packets of the same size for the same endpoint
+// are merged into a single message that the kernel splits up again (`UDP_SEGMENT`).
+//
+// With the io_uring backend (Linux only, opt-in at build time), every message of the batch becomes its own
+// SQE, but all of them are still submitted with a single syscall and the completions are awaited asynchronously.
+//
+// The packets are serialised directly into the storage handed out by `queue`. The storage is pooled and reused
+// between the flushes, so no allocations are made once the pool has grown to the usual batch size.
+//
+// Note: a sender must not be shared between coroutines that can flush concurrently.
+class BatchSender final
+{
+    BOOST_MOVABLE_BUT_NOT_COPYABLE(BatchSender)
+
+public:
+    static constexpr std::size_t MAX_PACKET_SIZE{MAX_RESPONSE_SIZE};
+
+    explicit BatchSender(boost::asio::ip::udp::socket& socket, const NetworkSettings& settings);
+
+    // Note: the returned storage is only valid until the next call
+    std::span<std::uint8_t> queue(const boost::asio::ip::udp::endpoint& endpoint, std::size_t size);
+
+    template<std::size_t Size>
+    std::span<std::uint8_t, Size> queue(const boost::asio::ip::udp::endpoint& endpoint);
+
+    boost::asio::awaitable<void> flush();
+
+#if defined(SDL2DSU_USE_IO_URING)
+    // Whether the messages are submitted via io_uring, i.e. it could be set up
+    bool isUsingIoUring() const;
+#endif
+
+private:
+    struct Packet
+    {
+        boost::asio::ip::udp::endpoint            m_endpoint;
+        std::array<std::uint8_t, MAX_PACKET_SIZE> m_data;
+        std::size_t                               m_size;
+    };
+
+    boost::asio::ip::udp::socket& m_socket;
+    std::vector<Packet>           m_packets;
+    std::size_t                   m_queued_packets{0};
+
+#if defined(__linux__)
+    struct ControlBuffer
+    {
+        alignas(cmsghdr) std::array<char, CMSG_SPACE(sizeof(std::uint16_t))> m_data;
+    };
+
+    void prepareHeaders(std::size_t first_packet);
+
+    bool                       m_segmentation_offload;
+    std::vector<mmsghdr>       m_headers;
+    std::vector<std::size_t>   m_header_packets;
+    std::vector<iovec>         m_iovecs;
+    std::vector<ControlBuffer> m_controls;
+#endif
+
+#if defined(SDL2DSU_USE_IO_URING)
+    // Returns the first message that was not submitted, which is past the end unless io_uring has failed
+    boost::asio::awaitable<std::size_t> flushWithIoUring();
+
+    std::optional<IoUring> m_io_uring;
+#endif
+};
+
+//--------------------------------------------------------------------------------------------------
+
+template<std::size_t Size>
+std::span<std::uint8_t, Size> BatchSender::queue(const boost::asio::ip::udp::endpoint& endpoint)
+{
+    static_assert(Size <= MAX_PACKET_SIZE);
+    return std::span<std::uint8_t, Size>{queue(endpoint, Size).data(), Size};
+}
+}  // namespace server
@@ -0,0 +1,16 @@
+#pragma once
+
+// system includes
+#include <chrono>
+
+// local includes
+
+//--------------------------------------------------------------------------------------------------
+
+namespace server
+{
+struct BroadcastSettings
+{
+    std::chrono::microseconds m_tick_interval{0};  // Zero means that every update is sent right away
+};
+}  // namespace server
@@ -2,6 +2,7 @@
 #include "clientendpoint.h"
 
 // system includes
+#include <boost/container_hash/hash.hpp>
 
 // local includes
 
@@ -9,8 +10,31 @@
 
 namespace server
 {
-bool operator<(const server::ClientEndpoint& lhs, const server::ClientEndpoint& rhs)
+bool operator==(const server::ClientEndpoint& lhs, const server::ClientEndpoint& rhs)
 {
-    return std::tie(lhs.m_client_id, lhs.m_endpoint) < std::tie(rhs.m_client_id, rhs.m_endpoint);
+    return lhs.m_client_id == rhs.m_client_id && lhs.m_endpoint == rhs.m_endpoint;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::size_t hashValue(const server::ClientEndpoint& client_endpoint)
+{
+    const auto& endpoint{client_endpoint.m_endpoint};
+    const auto  address{endpoint.address()};
+
+    std::size_t seed{0};
+    boost::hash_combine(seed, client_endpoint.m_client_id);
+    boost::hash_combine(seed, endpoint.port());
+    if (address.is_v4())
+    {
+        boost::hash_combine(seed, address.to_v4().to_uint());
+    }
+    else
+    {
+        const auto bytes{address.to_v6().to_bytes()};
+        boost::hash_range(seed, std::begin(bytes), std::end(bytes));
+    }
+
+    return seed;
 }
 }  // namespace server
@@ -2,7 +2,6 @@
 
 // system includes
 #include <boost/asio/ip/udp.hpp>
-#include <functional>
 
 // local includes
 
@@ -18,5 +17,9 @@ struct ClientEndpoint
 
 //--------------------------------------------------------------------------------------------------
 
-bool operator<(const server::ClientEndpoint& lhs, const server::ClientEndpoint& rhs);
+bool operator==(const server::ClientEndpoint& lhs, const server::ClientEndpoint& rhs);
+
+//--------------------------------------------------------------------------------------------------
+
+std::size_t hashValue(const server::ClientEndpoint& client_endpoint);
 }  // namespace server
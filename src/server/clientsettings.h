@@ -0,0 +1,20 @@
+#pragma once
+
+// system includes
+#include <chrono>
+#include <cstddef>
+
+// local includes
+
+//--------------------------------------------------------------------------------------------------
+
+namespace server
+{
+struct ClientSettings
+{
+    std::chrono::milliseconds m_timeout{5000};
+    std::size_t               m_max_clients{256};
+    std::size_t               m_max_clients_per_address{16};
+    std::chrono::microseconds m_min_send_interval{0};  // Per subscribed pad of a client, zero means unlimited
+};
+}  // namespace server
@@ -2,7 +2,7 @@
 
 // system includes
 #include <cstdint>
-#include <vector>
+#include <type_traits>
 
 // local includes
 
@@ -28,44 +28,4 @@ std::underlying_type_t<T> enumToValue(T enum_value)
 //--------------------------------------------------------------------------------------------------
 
 std::uint16_t getProtocolVersion();
-
-//--------------------------------------------------------------------------------------------------
-
-std::uint8_t readUInt8(const std::vector<std::uint8_t>& data, std::size_t& index, bool shift_index = true);
-
-//--------------------------------------------------------------------------------------------------
-
-std::uint16_t readUInt16LE(const std::vector<std::uint8_t>& data, std::size_t& index, bool shift_index = true);
-
-//--------------------------------------------------------------------------------------------------
-
-std::uint32_t readUInt32LE(const std::vector<std::uint8_t>& data, std::size_t& index, bool shift_index = true);
-
-//--------------------------------------------------------------------------------------------------
-
-std::int32_t readInt32LE(const std::vector<std::uint8_t>& data, std::size_t& index, bool shift_index = true);
-
-//--------------------------------------------------------------------------------------------------
-
-void writeUInt8(std::vector<std::uint8_t>& data, std::size_t& index, std::uint8_t value);
-
-//--------------------------------------------------------------------------------------------------
-
-void writeUInt16LE(std::vector<std::uint8_t>& data, std::size_t& index, std::uint16_t value);
-
-//--------------------------------------------------------------------------------------------------
-
-void writeUInt32LE(std::vector<std::uint8_t>& data, std::size_t& index, std::uint32_t value);
-
-//--------------------------------------------------------------------------------------------------
-
-void writeUInt64LE(std::vector<std::uint8_t>& data, std::size_t& index, std::uint64_t value);
-
-//--------------------------------------------------------------------------------------------------
-
-void writeFloatLE(std::vector<std::uint8_t>& data, std::size_t& index, float value);
-
-//--------------------------------------------------------------------------------------------------
-
-std::uint32_t calculateCrc32(const std::vector<std::uint8_t>& data);
 }  // namespace server
@@ -3,21 +3,19 @@
 
 // system includes
 #include <boost/algorithm/string/join.hpp>
-#include <boost/asio/experimental/as_tuple.hpp>
+#include <boost/asio/this_coro.hpp>
 #include <boost/asio/use_awaitable.hpp>
 #include <boost/log/trivial.hpp>
+#include <optional>
 #include <random>
 
 // local includes
+#include "batchreceiver.h"
+#include "batchsender.h"
 #include "deserialiser.h"
+#include "responsecache.h"
 #include "serialiser.h"
-
-//--------------------------------------------------------------------------------------------------
-
-namespace
-{
-constexpr auto use_nothrow_awaitable{boost::asio::experimental::as_tuple(boost::asio::use_awaitable)};
-}
+#include "shared/coroutines.h"
 
 //--------------------------------------------------------------------------------------------------
 
@@ -33,102 +31,222 @@ std::uint32_t generateServerId()
 
 //--------------------------------------------------------------------------------------------------
 
-boost::asio::awaitable<void> listenAndRespond(std::uint32_t server_id, const shared::GamepadDataContainer& gamepad_data,
-                                              ActiveClients& clients, boost::asio::ip::udp::socket& socket)
+boost::asio::awaitable<void> listenAndRespond(std::uint32_t                       server_id,
+                                              const shared::GamepadDataSnapshots& gamepad_data,
+                                              ActiveClients& clients, boost::asio::ip::udp::socket& socket,
+                                              const NetworkSettings&       settings,
+                                              const std::function<void()>& on_first_client)
 {
+    BOOST_ASSERT(on_first_client);
+
     BOOST_LOG_TRIVIAL(info) << "Server listening on " << socket.local_endpoint();
 
-    std::array<std::uint8_t, 1024> data;
+    BatchReceiver receiver{socket, settings};
+    BatchSender   sender{socket, settings};
+    ResponseCache cache{server_id, gamepad_data};
     for (;;)
     {
-        boost::asio::ip::udp::endpoint client;
-        const auto [receive_error, data_size] =
-            co_await socket.async_receive_from(boost::asio::buffer(data), client, use_nothrow_awaitable);
-
-        if (receive_error)
+        const auto datagrams{co_await receiver.receive()};
+        for (const auto& endpoint : receiver.getUnreachableEndpoints())
         {
-            BOOST_LOG_TRIVIAL(error) << "listenAndRespond::async_receive_from: [" << receive_error << "] "
-                                     << receive_error.message();
-            continue;
+            clients.removeEndpoint(endpoint);
         }
 
-        const auto result{deserialise({std::begin(data), std::begin(data) + data_size})};
-        if (!result)
+        for (const auto& datagram : datagrams)
         {
-            continue;
-        }
+            const auto& client{datagram.m_endpoint};
+            const auto  result{deserialise(datagram.m_data)};
+            if (!result)
+            {
+                continue;
+            }
 
-        std::vector<std::vector<std::uint8_t>> responses;
-        if (std::get_if<VersionRequest>(&*result))
-        {
-            responses = {serialise(VersionResponse{}, server_id)};
+            if (std::get_if<VersionRequest>(&*result))
+            {
+                const auto response{cache.getVersionResponse()};
+                std::copy(std::begin(response), std::end(response),
+                          std::begin(sender.queue<VERSION_RESPONSE_SIZE>(client)));
+            }
+            else if (const auto ports_request = std::get_if<ListPortsRequest>(&*result))
+            {
+                for (const auto pad_index : ports_request->m_requested_indexes)
+                {
+                    const auto response{cache.getListPortsResponse(pad_index)};
+                    std::copy(std::begin(response), std::end(response),
+                              std::begin(sender.queue<LIST_PORTS_RESPONSE_SIZE>(client)));
+                }
+            }
+            else if (const auto data_request = std::get_if<PadDataRequest>(&*result))
+            {
+                const bool had_clients{clients.getNumberOfClients() > 0};
+                clients.updateRequestTime(client, data_request->m_client_id, data_request->m_requested_indexes);
+                if (!had_clients && clients.getNumberOfClients() > 0)
+                {
+                    on_first_client();
+                }
+            }
         }
-        else if (const auto ports_request = std::get_if<ListPortsRequest>(&*result))
+
+        // All the replies for the whole batch are sent at once
+        co_await sender.flush();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+boost::asio::awaitable<void> distributePadData(std::uint32_t                       server_id,
+                                               const shared::GamepadDataSnapshots& gamepad_data,
+                                               ActiveClients& clients, boost::asio::ip::udp::socket& socket,
+                                               const NetworkSettings&     settings,
+                                               const BroadcastSettings&   broadcast_settings,
+                                               PadDataMailbox&            mailbox,
+                                               boost::asio::steady_timer& pending_timer)
+{
+    BatchSender                           sender{socket, settings};
+    std::chrono::steady_clock::time_point last_tick_time;
+    std::array<std::uint64_t, 4>          sent_sequences{};  // Of the last snapshot sent for each pad
+    std::chrono::steady_clock::time_point now;
+
+    // The response only differs in the packet counter between the clients, so it is serialised just once
+    const auto send_snapshot = [&](const std::uint8_t index, const shared::GamepadDataSnapshot& snapshot)
+    {
+        std::array<std::uint8_t, PAD_DATA_RESPONSE_SIZE> response;
+        serialise(PadDataResponse{index, snapshot.m_data}, server_id, response);
+        sent_sequences[index] = snapshot.m_sequence;
+
+        clients.forEachRelevantEndpoint(
+            index, now,
+            [&](const boost::asio::ip::udp::endpoint& endpoint, std::uint32_t packet_counter)
+            {
+                BOOST_LOG_TRIVIAL(debug) << "Serializing response for " << endpoint << ", for pad index "
+                                         << static_cast<int>(index);
+
+                const auto data{sender.queue<PAD_DATA_RESPONSE_SIZE>(endpoint)};
+                std::copy(std::begin(response), std::end(response), std::begin(data));
+                updatePacketCounter(data, packet_counter);
+            });
+    };
+
+    for (;;)
+    {
+        while (!mailbox.hasUpdates())
         {
-            responses = serialise(ListPortsResponse{ports_request->m_requested_indexes, gamepad_data}, server_id);
+            co_await mailbox.waitForWakeup();
         }
-        else if (const auto data_request = std::get_if<PadDataRequest>(&*result))
+
+        if (broadcast_settings.m_tick_interval.count() > 0)
         {
-            clients.updateRequestTime(client, data_request->m_client_id, data_request->m_requested_indexes);
+            // All the pads that are updated until the tick are sent together with their latest data. The first update
+            // after an idle period does not have to wait for the tick.
+            const auto next_tick_time{last_tick_time + broadcast_settings.m_tick_interval};
+            if (std::chrono::steady_clock::now() < next_tick_time)
+            {
+                // An immediate update is sent right away (together with the other pending ones), without shifting
+                // the ticks
+                while (!mailbox.hasImmediateUpdate() && std::chrono::steady_clock::now() < next_tick_time)
+                {
+                    co_await mailbox.waitForWakeup(next_tick_time);
+                }
+                if (std::chrono::steady_clock::now() >= next_tick_time)
+                {
+                    last_tick_time = next_tick_time;
+                }
+            }
+            else
+            {
+                last_tick_time = std::chrono::steady_clock::now();
+            }
         }
 
-        for (const auto& response : responses)
+        const auto updated_indexes{mailbox.take()};
+        now = std::chrono::steady_clock::now();
+        for (const auto index : updated_indexes)
         {
-            BOOST_ASSERT(!response.empty());
+            BOOST_LOG_TRIVIAL(debug) << "Sending updates for pad index: " << static_cast<int>(index);
 
-            const auto [send_error, sent_size] =
-                co_await socket.async_send_to(boost::asio::buffer(response), client, use_nothrow_awaitable);
-            if (send_error)
+            // The immediate updates that the input thread has overwritten in the meantime are sent first, in order
+            gamepad_data.forEachHeldSnapshot(index, sent_sequences[index],
+                                             [&](const auto& snapshot) { send_snapshot(index, snapshot); });
+
+            const auto snapshot{gamepad_data.readSnapshot(index)};
+            if (snapshot.m_sequence > sent_sequences[index])
             {
-                BOOST_LOG_TRIVIAL(error) << "listenAndRespond::async_send_to (sent " << sent_size << " bytes, "
-                                         << client << "): [" << send_error << "] " << send_error.message();
-                continue;
+                send_snapshot(index, snapshot);
             }
         }
+
+        // Note: changing the expiry wakes up the pending coroutine, which then waits for the new expiry instead
+        const auto next_pending_time{clients.getNextPendingTime()};
+        if (next_pending_time < pending_timer.expiry())
+        {
+            pending_timer.expires_at(next_pending_time);
+        }
+
+        // All the updated pads are sent at once. The pads that are updated in the meantime are simply picked up by
+        // the next iteration with their latest (and held) data.
+        co_await sender.flush();
     }
 }
 
 //--------------------------------------------------------------------------------------------------
 
-boost::asio::awaitable<void> distributePadData(std::uint32_t                       server_id,
-                                               const shared::GamepadDataContainer& gamepad_data,
-                                               const std::uint8_t index, ActiveClients& clients,
-                                               boost::asio::ip::udp::socket& socket)
+boost::asio::awaitable<void> distributePendingPadData(std::uint32_t                       server_id,
+                                                      const shared::GamepadDataSnapshots& gamepad_data,
+                                                      ActiveClients& clients, boost::asio::ip::udp::socket& socket,
+                                                      const NetworkSettings&      settings,
+                                                      boost::asio::steady_timer& pending_timer)
 {
-    BOOST_ASSERT(index < 4);
-    BOOST_LOG_TRIVIAL(debug) << "Sending updates for pad index: " << static_cast<int>(index);
-
-    std::map<boost::asio::ip::udp::endpoint, std::vector<std::vector<std::uint8_t>>> data_to_send;
-    const auto& relevant_endpoints{clients.getRelevantEndpoints(index)};
-    for (const auto& relevant_endpoint : relevant_endpoints)
+    // Using a separate sender, since `distributePadData` might be in the middle of flushing its own
+    BatchSender sender{socket, settings};
+    pending_timer.expires_at(clients.getNextPendingTime());
+    for (;;)
     {
-        BOOST_LOG_TRIVIAL(debug) << "Serializing response for " << relevant_endpoint.m_client_endpoint.m_endpoint
-                                 << ", for pad index " << static_cast<int>(index);
+        const auto [wait_error] = co_await pending_timer.async_wait(shared::use_nothrow_awaitable);
+        if (wait_error == boost::asio::error::operation_aborted)
+        {
+            // The expiry has been moved up
+            continue;
+        }
 
-        auto response{serialise(PadDataResponse{index, relevant_endpoint.m_client_endpoint.m_client_id,
-                                                relevant_endpoint.m_packet_counter, gamepad_data[index]},
-                                server_id)};
+        const auto now{std::chrono::steady_clock::now()};
+        for (std::uint8_t index = 0; index < gamepad_data.size(); ++index)
+        {
+            std::optional<std::array<std::uint8_t, PAD_DATA_RESPONSE_SIZE>> response;
+            clients.forEachPendingEndpoint(
+                index, now,
+                [&](const boost::asio::ip::udp::endpoint& endpoint, std::uint32_t packet_counter)
+                {
+                    if (!response)
+                    {
+                        response.emplace();
+                        serialise(PadDataResponse{index, gamepad_data.read(index)}, server_id, *response);
+                    }
+
+                    const auto data{sender.queue<PAD_DATA_RESPONSE_SIZE>(endpoint)};
+                    std::copy(std::begin(*response), std::end(*response), std::begin(data));
+                    updatePacketCounter(data, packet_counter);
+                });
+        }
+        co_await sender.flush();
 
-        BOOST_ASSERT(!response.empty());
-        data_to_send[relevant_endpoint.m_client_endpoint.m_endpoint].push_back(std::move(response));
+        // Pending clients may have been added while flushing
+        pending_timer.expires_at(clients.getNextPendingTime());
     }
+}
+
+//--------------------------------------------------------------------------------------------------
 
-    for (const auto& item : data_to_send)
+boost::asio::awaitable<void> expireInactiveClients(ActiveClients& clients)
+{
+    boost::asio::steady_timer timer(co_await boost::asio::this_coro::executor);
+    timer.expires_after(clients.getExpiryInterval());
+    for (;;)
     {
-        const auto  endpoint{item.first};
-        const auto& data_list{item.second};
+        co_await timer.async_wait(boost::asio::use_awaitable);
+        clients.expireClients(std::chrono::steady_clock::now());
 
-        for (const auto& data : data_list)
-        {
-            const auto [send_error, sent_size] =
-                co_await socket.async_send_to(boost::asio::buffer(data), endpoint, use_nothrow_awaitable);
-            if (send_error)
-            {
-                BOOST_LOG_TRIVIAL(error) << "listenAndRespond::async_send_to (sent " << sent_size << " bytes, "
-                                         << endpoint << "): [" << send_error << "] " << send_error.message();
-                continue;
-            }
-        }
+        // Scheduling relative to the previous expiry, so that the timer does not drift
+        timer.expires_at(timer.expiry() + clients.getExpiryInterval());
     }
 }
 }  // namespace server
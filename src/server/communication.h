@@ -3,10 +3,15 @@
 // system includes
 #include <boost/asio/awaitable.hpp>
 #include <boost/asio/ip/udp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <functional>
 
 // local includes
 #include "activeclients.h"
-#include "shared/gamepaddata.h"
+#include "broadcastsettings.h"
+#include "networksettings.h"
+#include "paddatamailbox.h"
+#include "shared/gamepaddatasnapshots.h"
 
 //--------------------------------------------------------------------------------------------------
 
@@ -16,13 +21,38 @@ std::uint32_t generateServerId();
 
 //--------------------------------------------------------------------------------------------------
 
-boost::asio::awaitable<void> listenAndRespond(std::uint32_t server_id, const shared::GamepadDataContainer& gamepad_data,
-                                              ActiveClients& clients, boost::asio::ip::udp::socket& socket);
+// Answers the requests of the clients. `on_first_client` is called whenever a pad data request brings the number of
+// clients up from zero.
+boost::asio::awaitable<void> listenAndRespond(std::uint32_t                       server_id,
+                                              const shared::GamepadDataSnapshots& gamepad_data,
+                                              ActiveClients& clients, boost::asio::ip::udp::socket& socket,
+                                              const NetworkSettings&       settings,
+                                              const std::function<void()>& on_first_client);
 
 //--------------------------------------------------------------------------------------------------
 
+// Sends the data of the pads posted to the mailbox to their subscribers, either right away or on the next broadcast
+// tick (unless an update with immediate priority is posted). Clients that are over their send rate are skipped and
+// `pending_timer` is moved up to when the first of them can receive the latest data again.
 boost::asio::awaitable<void> distributePadData(std::uint32_t                       server_id,
-                                               const shared::GamepadDataContainer& gamepad_data,
-                                               const std::uint8_t index, ActiveClients& clients,
-                                               boost::asio::ip::udp::socket& socket);
+                                               const shared::GamepadDataSnapshots& gamepad_data,
+                                               ActiveClients& clients, boost::asio::ip::udp::socket& socket,
+                                               const NetworkSettings&     settings,
+                                               const BroadcastSettings&   broadcast_settings,
+                                               PadDataMailbox&            mailbox,
+                                               boost::asio::steady_timer& pending_timer);
+
+//--------------------------------------------------------------------------------------------------
+
+// Sends the latest pad data to the clients that were skipped by `distributePadData` once they are within their send
+// rate again
+boost::asio::awaitable<void> distributePendingPadData(std::uint32_t                       server_id,
+                                                      const shared::GamepadDataSnapshots& gamepad_data,
+                                                      ActiveClients& clients, boost::asio::ip::udp::socket& socket,
+                                                      const NetworkSettings&      settings,
+                                                      boost::asio::steady_timer& pending_timer);
+
+//--------------------------------------------------------------------------------------------------
+
+boost::asio::awaitable<void> expireInactiveClients(ActiveClients& clients);
 }  // namespace server
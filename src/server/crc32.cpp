@@ -0,0 +1,341 @@
+// class header include
+#include "crc32.h"
+
+// system includes
+#include <array>
+#include <boost/crc.hpp>
+#include <boost/log/trivial.hpp>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #define SDL2DSU_CRC32_PCLMUL
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#endif
+
+#if defined(__aarch64__) && defined(__linux__) && (defined(__GNUC__) || defined(__clang__))
+    #define SDL2DSU_CRC32_ARMV8
+    #include <arm_acle.h>
+    #include <asm/hwcap.h>
+    #include <sys/auxv.h>
+#endif
+
+// local includes
+
+//--------------------------------------------------------------------------------------------------
+
+namespace
+{
+using Crc32Kernel   = std::uint32_t (*)(std::uint32_t crc, const std::uint8_t* data, std::size_t size);
+using Crc32Function = decltype(server::Crc32Implementation::m_calculate);
+using Crc32Tables   = std::array<std::array<std::uint32_t, 256>, 8>;
+
+//--------------------------------------------------------------------------------------------------
+
+Crc32Tables makeCrc32Tables()
+{
+    constexpr std::uint32_t polynomial{0xEDB88320 /* reflected CRC32 polynomial */};
+
+    Crc32Tables tables{};
+    for (std::uint32_t value = 0; value < 256; ++value)
+    {
+        std::uint32_t crc{value};
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc >> 1) ^ ((crc & 1) != 0 ? polynomial : 0);
+        }
+        tables[0][value] = crc;
+    }
+
+    // Each of the following tables advances the previous one by another zero byte
+    for (std::size_t i = 1; i < tables.size(); ++i)
+    {
+        for (std::size_t value = 0; value < 256; ++value)
+        {
+            const std::uint32_t previous{tables[i - 1][value]};
+            tables[i][value] = (previous >> 8) ^ tables[0][previous & 0xFF];
+        }
+    }
+
+    return tables;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::uint32_t loadUInt32LE(const std::uint8_t* data)
+{
+    return static_cast<std::uint32_t>(data[0]) | static_cast<std::uint32_t>(data[1]) << 8
+           | static_cast<std::uint32_t>(data[2]) << 16 | static_cast<std::uint32_t>(data[3]) << 24;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::uint32_t crc32SlicingBy8(std::uint32_t crc, const std::uint8_t* data, std::size_t size)
+{
+    static const Crc32Tables tables{makeCrc32Tables()};
+
+    while (size >= 8)
+    {
+        const std::uint32_t first{loadUInt32LE(data) ^ crc};
+        const std::uint32_t second{loadUInt32LE(data + 4)};
+
+        crc = tables[7][first & 0xFF] ^ tables[6][(first >> 8) & 0xFF] ^ tables[5][(first >> 16) & 0xFF]
+              ^ tables[4][first >> 24] ^ tables[3][second & 0xFF] ^ tables[2][(second >> 8) & 0xFF]
+              ^ tables[1][(second >> 16) & 0xFF] ^ tables[0][second >> 24];
+
+        data += 8;
+        size -= 8;
+    }
+
+    while (size > 0)
+    {
+        crc = (crc >> 8) ^ tables[0][(crc ^ *data) & 0xFF];
+
+        ++data;
+        --size;
+    }
+
+    return crc;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+#if defined(SDL2DSU_CRC32_PCLMUL)
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #define SDL2DSU_PCLMUL_TARGET
+    #else
+        #define SDL2DSU_PCLMUL_TARGET __attribute__((target("pclmul,sse4.1")))
+    #endif
+
+bool hasPclmulSupport()
+{
+    std::uint32_t ecx{0};
+    #if defined(_MSC_VER)
+    std::array<int, 4> info{};
+    __cpuid(info.data(), 1);
+    ecx = static_cast<std::uint32_t>(info[2]);
+    #else
+    unsigned int eax{0};
+    unsigned int ebx{0};
+    unsigned int edx{0};
+    unsigned int ecx_value{0};
+    if (__get_cpuid(1, &eax, &ebx, &ecx_value, &edx) == 0)
+    {
+        return false;
+    }
+    ecx = ecx_value;
+    #endif
+
+    constexpr std::uint32_t pclmul_bit{1u << 1};
+    constexpr std::uint32_t sse41_bit{1u << 19};
+    return (ecx & pclmul_bit) != 0 && (ecx & sse41_bit) != 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+SDL2DSU_PCLMUL_TARGET __m128i load128(const std::uint8_t* data)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+SDL2DSU_PCLMUL_TARGET __m128i fold128(__m128i value, __m128i next, __m128i constants)
+{
+    const __m128i low{_mm_clmulepi64_si128(value, constants, 0x00)};
+    const __m128i high{_mm_clmulepi64_si128(value, constants, 0x11)};
+    return _mm_xor_si128(_mm_xor_si128(high, low), next);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Folds 64 bytes at a time with carry-less multiplications and reduces the remainder with a Barrett reduction (see
+// Intel's "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction"). The bytes that do not fill a
+// whole 16-byte block are handled by the table based implementation.
+SDL2DSU_PCLMUL_TARGET std::uint32_t crc32Pclmul(std::uint32_t crc, const std::uint8_t* data, std::size_t size)
+{
+    if (size < 64)
+    {
+        return crc32SlicingBy8(crc, data, size);
+    }
+
+    alignas(16) static constexpr std::uint64_t k1k2[]{0x0154442BD4, 0x01C6E41596};
+    alignas(16) static constexpr std::uint64_t k3k4[]{0x01751997D0, 0x00CCAA009E};
+    alignas(16) static constexpr std::uint64_t k5k0[]{0x0163CD6124, 0x0000000000};
+    alignas(16) static constexpr std::uint64_t poly[]{0x01DB710641, 0x01F7011641};
+
+    __m128i x1{_mm_xor_si128(load128(data), _mm_cvtsi32_si128(static_cast<int>(crc)))};
+    __m128i x2{load128(data + 16)};
+    __m128i x3{load128(data + 32)};
+    __m128i x4{load128(data + 48)};
+    __m128i x0{_mm_load_si128(reinterpret_cast<const __m128i*>(k1k2))};
+    data += 64;
+    size -= 64;
+
+    // Fold by 4 x 128 bits
+    while (size >= 64)
+    {
+        x1 = fold128(x1, load128(data), x0);
+        x2 = fold128(x2, load128(data + 16), x0);
+        x3 = fold128(x3, load128(data + 32), x0);
+        x4 = fold128(x4, load128(data + 48), x0);
+
+        data += 64;
+        size -= 64;
+    }
+
+    // Fold into 128 bits
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4));
+    x1 = fold128(x1, x2, x0);
+    x1 = fold128(x1, x3, x0);
+    x1 = fold128(x1, x4, x0);
+
+    while (size >= 16)
+    {
+        x1 = fold128(x1, load128(data), x0);
+
+        data += 16;
+        size -= 16;
+    }
+
+    // Fold 128 bits into 64 bits
+    const __m128i mask{_mm_setr_epi32(~0, 0, ~0, 0)};
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+    x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0));
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, mask), x0, 0x00), x2);
+
+    // Barrett reduction to 32 bits
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(poly));
+    x2 = _mm_and_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, mask), x0, 0x10), mask);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return crc32SlicingBy8(static_cast<std::uint32_t>(_mm_extract_epi32(x1, 1)), data, size);
+}
+#endif
+
+//--------------------------------------------------------------------------------------------------
+
+#if defined(SDL2DSU_CRC32_ARMV8)
+    #if defined(__clang__)
+        #define SDL2DSU_ARMV8_CRC_TARGET __attribute__((target("crc")))
+    #else
+        #define SDL2DSU_ARMV8_CRC_TARGET __attribute__((target("+crc")))
+    #endif
+
+SDL2DSU_ARMV8_CRC_TARGET std::uint32_t crc32Armv8(std::uint32_t crc, const std::uint8_t* data, std::size_t size)
+{
+    while (size >= 8)
+    {
+        std::uint64_t value;
+        std::memcpy(&value, data, sizeof(value));
+        crc = __crc32d(crc, value);
+
+        data += 8;
+        size -= 8;
+    }
+
+    while (size > 0)
+    {
+        crc = __crc32b(crc, *data);
+
+        ++data;
+        --size;
+    }
+
+    return crc;
+}
+#endif
+
+//--------------------------------------------------------------------------------------------------
+
+// The kernels work on the inverted checksum, so that it does not have to be inverted between the chunks
+template<Crc32Kernel kernel>
+std::uint32_t calculateWith(std::span<const std::uint8_t> data, std::uint32_t crc)
+{
+    return ~kernel(~crc, data.data(), data.size());
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool matchesBoost(Crc32Function calculate)
+{
+    std::array<std::uint8_t, 256> data{};
+    for (std::size_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = static_cast<std::uint8_t>(i * 31 + 7);
+    }
+
+    // Every size is checked, so that all the tail handling paths are covered as well
+    for (std::size_t size = 0; size <= data.size(); ++size)
+    {
+        boost::crc_32_type crc;
+        crc.process_bytes(data.data(), size);
+        if (crc.checksum() != calculate(std::span{data.data(), size}, 0))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+Crc32Function selectImplementation()
+{
+    for (const auto& implementation : server::getSupportedCrc32Implementations())
+    {
+        if (!matchesBoost(implementation.m_calculate))
+        {
+            BOOST_LOG_TRIVIAL(warning) << "CRC32 implementation " << implementation.m_name
+                                       << " does not match the reference implementation, skipping it.";
+            continue;
+        }
+
+        BOOST_LOG_TRIVIAL(debug) << "Using " << implementation.m_name << " CRC32 implementation.";
+        return implementation.m_calculate;
+    }
+
+    return &calculateWith<&crc32SlicingBy8>;
+}
+}  // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+namespace server
+{
+std::uint32_t calculateCrc32(std::span<const std::uint8_t> data, std::uint32_t crc)
+{
+    static const Crc32Function calculate{selectImplementation()};
+    return calculate(data, crc);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::vector<Crc32Implementation> getSupportedCrc32Implementations()
+{
+    // Ordered by preference, the table based implementation is always available as the last resort
+    std::vector<Crc32Implementation> implementations;
+#if defined(SDL2DSU_CRC32_PCLMUL)
+    if (hasPclmulSupport())
+    {
+        implementations.push_back({"PCLMULQDQ", &calculateWith<&crc32Pclmul>});
+    }
+#endif
+#if defined(SDL2DSU_CRC32_ARMV8)
+    if ((getauxval(AT_HWCAP) & HWCAP_CRC32) != 0)
+    {
+        implementations.push_back({"ARMv8 CRC32", &calculateWith<&crc32Armv8>});
+    }
+#endif
+    implementations.push_back({"slicing-by-8", &calculateWith<&crc32SlicingBy8>});
+    return implementations;
+}
+}  // namespace server
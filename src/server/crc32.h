@@ -0,0 +1,31 @@
+#pragma once
+
+// system includes
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// local includes
+
+//--------------------------------------------------------------------------------------------------
+
+namespace server
+{
+// Calculates the CRC32 (IEEE polynomial) using the fastest implementation that the CPU supports. The implementation
+// is selected (and verified against Boost) on the first call. The checksum of a previous chunk can be passed as `crc`
+// to continue the calculation over multiple chunks.
+std::uint32_t calculateCrc32(std::span<const std::uint8_t> data, std::uint32_t crc = 0);
+
+//--------------------------------------------------------------------------------------------------
+
+// One of the implementations behind `calculateCrc32`, with the same signature and result
+struct Crc32Implementation
+{
+    const char* m_name;
+    std::uint32_t (*m_calculate)(std::span<const std::uint8_t> data, std::uint32_t crc);
+};
+
+// Returns the implementations that are compiled in and supported by the CPU, ordered by preference (for testing and
+// benchmarking them one by one, `calculateCrc32` picks the first one that matches Boost)
+std::vector<Crc32Implementation> getSupportedCrc32Implementations();
+}  // namespace server
@@ -2,10 +2,14 @@
 #include "deserialiser.h"
 
 // system includes
+#include <algorithm>
 #include <boost/log/trivial.hpp>
+#include <cstring>
 
 // local includes
 #include "common.h"
+#include "crc32.h"
+#include "packetlayout.h"
 
 //--------------------------------------------------------------------------------------------------
 
@@ -17,19 +21,32 @@ const std::size_t MIN_DATA_SIZE{8 /* Data size up to and including the packet si
 
 //--------------------------------------------------------------------------------------------------
 
-std::optional<ListPortsRequest> deserialiseListPorts(std::vector<std::uint8_t>& data, std::size_t& index)
+// Note: the fields that are not present in the data are left zero-ed out
+template<class Layout>
+Layout readLayout(std::span<const std::uint8_t> data)
 {
-    const auto request_size{readInt32LE(data, index)};
-    if (request_size < 0 || request_size > 4)
+    Layout layout{};
+    std::memcpy(&layout, data.data(), std::min(data.size(), sizeof(Layout)));
+    return layout;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::optional<ListPortsRequest> deserialiseListPorts(std::span<const std::uint8_t> data)
+{
+    const auto layout{readLayout<ListPortsRequestLayout>(data)};
+    const auto request_size{layout.m_request_size.get()};
+    if (request_size < 0 || request_size > 4
+        || offsetof(ListPortsRequestLayout, m_indexes) + static_cast<std::size_t>(request_size) > data.size())
     {
         BOOST_LOG_TRIVIAL(trace) << "DSU Client packet received with invalid request size: " << request_size;
         return std::nullopt;
     }
 
-    std::set<std::uint8_t> requested_indexes;
+    shared::PadIndexSet requested_indexes;
     for (auto i = 0; i < request_size; ++i)
     {
-        const auto req_index{readUInt8(data, index)};
+        const auto req_index{layout.m_indexes[i]};
         if (req_index > 3)
         {
             BOOST_LOG_TRIVIAL(trace) << "DSU Client packet received with invalid request index: " << req_index;
@@ -39,18 +56,24 @@ std::optional<ListPortsRequest> deserialiseListPorts(std::vector<std::uint8_t>&
         requested_indexes.insert(req_index);
     }
 
-    return ListPortsRequest{std::move(requested_indexes)};
+    return ListPortsRequest{requested_indexes};
 }
 
 //--------------------------------------------------------------------------------------------------
 
-std::optional<PadDataRequest> deserialisePadData(std::uint32_t client_id, std::vector<std::uint8_t>& data,
-                                                 std::size_t& index)
+std::optional<PadDataRequest> deserialisePadData(std::uint32_t client_id, std::span<const std::uint8_t> data)
 {
-    std::set<std::uint8_t> requested_indexes;
-    const auto             req_flag{readUInt8(data, index)};
+    if (data.size() < offsetof(PadDataRequestLayout, m_mac) + 1)
+    {
+        BOOST_LOG_TRIVIAL(trace) << "DSU Client packet received with invalid pad data request size: " << data.size();
+        return std::nullopt;
+    }
+
+    const auto          layout{readLayout<PadDataRequestLayout>(data)};
+    shared::PadIndexSet requested_indexes;
+    const auto          req_flag{layout.m_flags};
 
-    std::uint8_t req_index{readUInt8(data, index)};
+    const std::uint8_t req_index{layout.m_slot};
     if (req_flag & 0x01 /* slot based registration */)
     {
         if (req_index > 3)
@@ -63,7 +86,7 @@ std::optional<PadDataRequest> deserialisePadData(std::uint32_t client_id, std::v
     }
 
     // This is custom MAC address handling where the first byte corresponds to the slot index
-    std::uint8_t mac_index{readUInt8(data, index)};
+    const std::uint8_t mac_index{layout.m_mac[0]};
     if (req_flag & 0x02 /* MAC based registration */)
     {
         if (mac_index <= 3)
@@ -79,25 +102,23 @@ std::optional<PadDataRequest> deserialisePadData(std::uint32_t client_id, std::v
 //--------------------------------------------------------------------------------------------------
 
 std::optional<std::variant<VersionRequest, ListPortsRequest, PadDataRequest>>
-    deserialise(std::vector<std::uint8_t> data)
+    deserialise(std::span<const std::uint8_t> data)
 {
+    // Only the first 8 bytes are needed to reject unrelated traffic, so that is done before any further work
     if (data.size() < MIN_DATA_SIZE)
     {
         BOOST_LOG_TRIVIAL(trace) << "Got data packet of size: " << data.size();
         return std::nullopt;
     }
 
-    std::size_t index{0};
-    if (readUInt8(data, index) != 'D' ||  //
-        readUInt8(data, index) != 'S' ||  //
-        readUInt8(data, index) != 'U' ||  //
-        readUInt8(data, index) != 'C')
+    const auto header{readLayout<DsuHeader>(data)};
+    if (header.m_magic != std::array<std::uint8_t, 4>{'D', 'S', 'U', 'C'})
     {
         BOOST_LOG_TRIVIAL(trace) << "Got non-DSU Client related packet of size: " << data.size();
         return std::nullopt;
     }
 
-    const auto protocol_version{readUInt16LE(data, index)};
+    const auto protocol_version{header.m_protocol_version.get()};
     if (protocol_version != getProtocolVersion())
     {
         BOOST_LOG_TRIVIAL(trace) << "DSU Client requested protocol version: " << protocol_version << ". Ours is "
@@ -105,7 +126,7 @@ std::optional<std::variant<VersionRequest, ListPortsRequest, PadDataRequest>>
         return std::nullopt;
     }
 
-    const auto packet_size{readUInt16LE(data, index)};
+    const auto packet_size{header.m_packet_size.get()};
     if (packet_size + MIN_DATA_SIZE > data.size())
     {
         BOOST_LOG_TRIVIAL(trace) << "DSU Client packet received with size mismatch: " << packet_size + MIN_DATA_SIZE
@@ -113,10 +134,20 @@ std::optional<std::variant<VersionRequest, ListPortsRequest, PadDataRequest>>
         return std::nullopt;
     }
 
-    const auto packet_crc32{readUInt32LE(data, index, false)};
-    writeUInt32LE(data, index, 0u);  // Clear the CRC so that it can be calculated
+    if (data.size() < sizeof(DsuHeader))
+    {
+        BOOST_LOG_TRIVIAL(trace) << "DSU Client packet received without a complete header: " << data.size();
+        return std::nullopt;
+    }
+
+    // The CRC is calculated as if the CRC bytes were zero-ed out, which is done piecewise to avoid copying the data
+    constexpr std::size_t                                      crc_offset{offsetof(DsuHeader, m_crc32)};
+    constexpr std::array<std::uint8_t, sizeof(header.m_crc32)> zero_crc{};
 
-    const auto calculated_crc{calculateCrc32(data)};
+    const auto packet_crc32{header.m_crc32.get()};
+    auto       calculated_crc{calculateCrc32(data.first(crc_offset))};
+    calculated_crc = calculateCrc32(zero_crc, calculated_crc);
+    calculated_crc = calculateCrc32(data.subspan(crc_offset + zero_crc.size()), calculated_crc);
     if (packet_crc32 != calculated_crc)
     {
         BOOST_LOG_TRIVIAL(trace) << "DSU Client packet crc32 mismatch: " << packet_crc32 << ". We got "
@@ -124,8 +155,8 @@ std::optional<std::variant<VersionRequest, ListPortsRequest, PadDataRequest>>
         return std::nullopt;
     }
 
-    const auto client_id = readUInt32LE(data, index);
-    const auto msg_type  = readUInt32LE(data, index);
+    const auto client_id{header.m_id.get()};
+    const auto msg_type{header.m_msg_type.get()};
 
     if (msg_type == enumToValue(DsuMsgType::Version))
     {
@@ -135,12 +166,12 @@ std::optional<std::variant<VersionRequest, ListPortsRequest, PadDataRequest>>
     else if (msg_type == enumToValue(DsuMsgType::ListPorts))
     {
         BOOST_LOG_TRIVIAL(trace) << "DSU Client " << client_id << " requested available ports.";
-        return deserialiseListPorts(data, index);
+        return deserialiseListPorts(data);
     }
     else if (msg_type == enumToValue(DsuMsgType::PadData))
     {
         BOOST_LOG_TRIVIAL(trace) << "DSU Client " << client_id << " requested pad data.";
-        return deserialisePadData(client_id, data, index);
+        return deserialisePadData(client_id, data);
     }
 
     BOOST_LOG_TRIVIAL(trace) << "DSU Client packet contains unhandle msg type " << msg_type << " from client "
@@ -3,11 +3,11 @@
 // system includes
 #include <cstdint>
 #include <optional>
-#include <set>
+#include <span>
 #include <variant>
-#include <vector>
 
 // local includes
+#include "shared/padindexset.h"
 
 //--------------------------------------------------------------------------------------------------
 
@@ -21,19 +21,19 @@ struct VersionRequest
 
 struct ListPortsRequest
 {
-    std::set<std::uint8_t> m_requested_indexes;
+    shared::PadIndexSet m_requested_indexes;
 };
 
 //--------------------------------------------------------------------------------------------------
 
 struct PadDataRequest
 {
-    std::uint32_t          m_client_id;
-    std::set<std::uint8_t> m_requested_indexes;
+    std::uint32_t       m_client_id;
+    shared::PadIndexSet m_requested_indexes;
 };
 
 //--------------------------------------------------------------------------------------------------
 
 std::optional<std::variant<VersionRequest, ListPortsRequest, PadDataRequest>>
-    deserialise(std::vector<std::uint8_t> data);
+    deserialise(std::span<const std::uint8_t> data);
 }  // namespace server
@@ -0,0 +1,290 @@
+// class header include
+#include "iouring.h"
+
+// system includes
+#include <boost/asio/error.hpp>
+#include <boost/log/trivial.hpp>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// local includes
+#include "shared/coroutines.h"
+
+//--------------------------------------------------------------------------------------------------
+
+namespace
+{
+std::runtime_error makeError(const std::string& what)
+{
+    return std::runtime_error{what + ": " + std::strerror(errno)};
+}
+
+//--------------------------------------------------------------------------------------------------
+
+template<class T>
+T* offsetPtr(void* base, std::uint32_t offset)
+{
+    return reinterpret_cast<T*>(static_cast<std::uint8_t*>(base) + offset);
+}
+}  // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+namespace server
+{
+IoUring::IoUring(const boost::asio::any_io_executor& executor, unsigned int entries)
+    : m_event{executor}
+{
+    io_uring_params params{};
+    m_ring_fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+    if (m_ring_fd < 0)
+    {
+        throw makeError("io_uring_setup failed");
+    }
+
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) == 0)
+    {
+        release();
+        throw std::runtime_error{"io_uring is too old (IORING_FEAT_SINGLE_MMAP is not supported)"};
+    }
+
+    // With IORING_FEAT_SINGLE_MMAP the submission and completion rings share the same mapping
+    m_sq_ring_size = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned int),
+                              params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    m_sq_ring      = ::mmap(nullptr, m_sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd,
+                            IORING_OFF_SQ_RING);
+    if (m_sq_ring == MAP_FAILED)
+    {
+        const auto error{makeError("io_uring ring mmap failed")};
+        m_sq_ring = nullptr;
+        release();
+        throw error;
+    }
+    m_cq_ring      = m_sq_ring;
+    m_cq_ring_size = m_sq_ring_size;
+
+    m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes{::mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd,
+                      IORING_OFF_SQES)};
+    if (sqes == MAP_FAILED)
+    {
+        const auto error{makeError("io_uring SQE mmap failed")};
+        release();
+        throw error;
+    }
+    m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+    m_sq_head    = offsetPtr<unsigned int>(m_sq_ring, params.sq_off.head);
+    m_sq_tail    = offsetPtr<unsigned int>(m_sq_ring, params.sq_off.tail);
+    m_sq_array   = offsetPtr<unsigned int>(m_sq_ring, params.sq_off.array);
+    m_sq_flags   = offsetPtr<unsigned int>(m_sq_ring, params.sq_off.flags);
+    m_sq_mask    = *offsetPtr<unsigned int>(m_sq_ring, params.sq_off.ring_mask);
+    m_sq_entries = *offsetPtr<unsigned int>(m_sq_ring, params.sq_off.ring_entries);
+
+    m_cq_head = offsetPtr<unsigned int>(m_cq_ring, params.cq_off.head);
+    m_cq_tail = offsetPtr<unsigned int>(m_cq_ring, params.cq_off.tail);
+    m_cqes    = offsetPtr<io_uring_cqe>(m_cq_ring, params.cq_off.cqes);
+    m_cq_mask = *offsetPtr<unsigned int>(m_cq_ring, params.cq_off.ring_mask);
+
+    // The kernel signals the eventfd for every posted completion, which is what the io_context waits for
+    const int event_fd{::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)};
+    if (event_fd < 0)
+    {
+        const auto error{makeError("eventfd failed")};
+        release();
+        throw error;
+    }
+    m_event.assign(event_fd);
+
+    if (::syscall(__NR_io_uring_register, m_ring_fd, IORING_REGISTER_EVENTFD, &event_fd, 1) < 0)
+    {
+        const auto error{makeError("io_uring eventfd registration failed")};
+        release();
+        throw error;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+IoUring::~IoUring()
+{
+    release();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+io_uring_sqe* IoUring::tryGetSqe()
+{
+    const unsigned int head{std::atomic_ref<unsigned int>{*m_sq_head}.load(std::memory_order_acquire)};
+    if (m_sqe_tail - head >= m_sq_entries)
+    {
+        return nullptr;
+    }
+
+    io_uring_sqe* const sqe{&m_sqes[m_sqe_tail & m_sq_mask]};
+    std::memset(sqe, 0, sizeof(io_uring_sqe));
+
+    ++m_sqe_tail;
+    return sqe;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::size_t IoUring::submit(boost::system::error_code& error)
+{
+    error.clear();
+
+    std::atomic_ref<unsigned int>       sq_tail{*m_sq_tail};
+    const std::atomic_ref<unsigned int> sq_head{*m_sq_head};
+
+    unsigned int tail{sq_tail.load(std::memory_order_relaxed)};
+    while (m_sqe_head != m_sqe_tail)
+    {
+        m_sq_array[tail & m_sq_mask] = m_sqe_head & m_sq_mask;
+        ++tail;
+        ++m_sqe_head;
+    }
+    sq_tail.store(tail, std::memory_order_release);
+
+    // All the prepared entries are handed over to the kernel with a single syscall, unless it stops early
+    const unsigned int first_head{sq_head.load(std::memory_order_acquire)};
+    unsigned int       head{first_head};
+    while (head != tail)
+    {
+        const long result{::syscall(__NR_io_uring_enter, m_ring_fd, tail - head, 0, 0, nullptr, 0)};
+        if (result < 0 && errno != EINTR)
+        {
+            error = boost::system::error_code{errno, boost::system::system_category()};
+            break;
+        }
+        if (result == 0)
+        {
+            error = boost::asio::error::try_again;
+            break;
+        }
+        head = sq_head.load(std::memory_order_acquire);
+    }
+
+    if (error)
+    {
+        // Without SQPOLL the kernel only reads the queue while entering, so the rest can simply be withdrawn
+        head = sq_head.load(std::memory_order_acquire);
+        sq_tail.store(head, std::memory_order_release);
+        m_sqe_head = head;
+        m_sqe_tail = head;
+    }
+    return head - first_head;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+boost::asio::awaitable<void> IoUring::waitForCompletions()
+{
+    // Completions that did not fit into the queue are only moved over when entering the kernel
+    if ((std::atomic_ref<unsigned int>{*m_sq_flags}.load(std::memory_order_relaxed) & IORING_SQ_CQ_OVERFLOW) != 0)
+    {
+        if (::syscall(__NR_io_uring_enter, m_ring_fd, 0, 0, IORING_ENTER_GETEVENTS, nullptr, 0) < 0)
+        {
+            BOOST_LOG_TRIVIAL(error) << "IoUring::flush_overflow: [" << errno << "] " << std::strerror(errno);
+        }
+    }
+
+    const std::atomic_ref<unsigned int> cq_head{*m_cq_head};
+    const std::atomic_ref<unsigned int> cq_tail{*m_cq_tail};
+    if (cq_head.load(std::memory_order_relaxed) != cq_tail.load(std::memory_order_acquire))
+    {
+        co_return;
+    }
+
+    const auto [wait_error] =
+        co_await m_event.async_wait(boost::asio::posix::descriptor_base::wait_read, shared::use_nothrow_awaitable);
+    if (wait_error)
+    {
+        BOOST_LOG_TRIVIAL(error) << "IoUring::async_wait: [" << wait_error << "] " << wait_error.message();
+        co_return;
+    }
+
+    // Reset the eventfd counter, it does not matter how many completions it has counted
+    std::uint64_t counter{0};
+    if (::read(m_event.native_handle(), &counter, sizeof(counter)) < 0 && errno != EAGAIN)
+    {
+        BOOST_LOG_TRIVIAL(error) << "IoUring::read: [" << errno << "] " << std::strerror(errno);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+io_uring_buf_ring& IoUring::createBufferRing(unsigned int entries, std::uint16_t group_id)
+{
+    BOOST_ASSERT(m_buffer_ring == nullptr);
+    BOOST_ASSERT((entries & (entries - 1)) == 0);
+
+    // The ring needs to be page aligned, which is what the anonymous mapping gives us
+    const std::size_t size{entries * sizeof(io_uring_buf)};
+
+    void* const buffer_ring{::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE,
+                                   -1, 0)};
+    if (buffer_ring == MAP_FAILED)
+    {
+        throw makeError("io_uring buffer ring mmap failed");
+    }
+
+    io_uring_buf_reg registration{};
+    registration.ring_addr    = reinterpret_cast<std::uint64_t>(buffer_ring);
+    registration.ring_entries = entries;
+    registration.bgid         = group_id;
+
+    if (::syscall(__NR_io_uring_register, m_ring_fd, IORING_REGISTER_PBUF_RING, &registration, 1) < 0)
+    {
+        const auto error{makeError("io_uring buffer ring registration failed")};
+        ::munmap(buffer_ring, size);
+        throw error;
+    }
+
+    m_buffer_ring      = buffer_ring;
+    m_buffer_ring_size = size;
+    return *static_cast<io_uring_buf_ring*>(buffer_ring);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void IoUring::release()
+{
+    if (m_ring_fd >= 0)
+    {
+        // Closing the ring also drops the buffer ring registration
+        ::close(m_ring_fd);
+        m_ring_fd = -1;
+    }
+
+    if (m_buffer_ring != nullptr)
+    {
+        ::munmap(m_buffer_ring, m_buffer_ring_size);
+        m_buffer_ring = nullptr;
+    }
+
+    if (m_sqes != nullptr)
+    {
+        ::munmap(m_sqes, m_sqes_size);
+        m_sqes = nullptr;
+    }
+
+    if (m_sq_ring != nullptr)
+    {
+        ::munmap(m_sq_ring, m_sq_ring_size);
+        m_sq_ring = nullptr;
+        m_cq_ring = nullptr;
+    }
+
+    if (m_event.is_open())
+    {
+        boost::system::error_code ignored;
+        m_event.close(ignored);
+    }
+}
+}  // namespace server
@@ -0,0 +1,95 @@
+#pragma once
+
+// system includes
+#include <atomic>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/move/core.hpp>
+#include <boost/system/error_code.hpp>
+#include <limits>
+#include <linux/io_uring.h>
+
+// local includes
+
+//--------------------------------------------------------------------------------------------------
+
+namespace server
+{
+// Minimal io_uring wrapper (without liburing) that is driven by the Asio event loop. The completions are
+// signalled through an eventfd that is watched by the `io_context`, so awaiting them never blocks the thread.
+class IoUring final
+{
+    BOOST_MOVABLE_BUT_NOT_COPYABLE(IoUring)
+
+public:
+    explicit IoUring(const boost::asio::any_io_executor& executor, unsigned int entries);
+    ~IoUring();
+
+    io_uring_sqe* tryGetSqe();
+
+    // Hands the prepared entries over to the kernel and returns how many it has taken. On failure, the entries it has
+    // not taken are dropped and can be prepared again. `EBUSY` means that the completion queue has overflowed, so the
+    // completions have to be consumed before submitting again.
+    std::size_t submit(boost::system::error_code& error);
+
+    boost::asio::awaitable<void> waitForCompletions();
+    io_uring_buf_ring&           createBufferRing(unsigned int entries, std::uint16_t group_id);
+
+    template<class Handler>
+    std::size_t consumeCompletions(Handler&& handler, std::size_t max_count = std::numeric_limits<std::size_t>::max());
+
+private:
+    void release();
+
+    int                                   m_ring_fd{-1};
+    boost::asio::posix::stream_descriptor m_event;
+
+    void*         m_sq_ring{nullptr};
+    std::size_t   m_sq_ring_size{0};
+    void*         m_cq_ring{nullptr};
+    std::size_t   m_cq_ring_size{0};
+    io_uring_sqe* m_sqes{nullptr};
+    std::size_t   m_sqes_size{0};
+
+    unsigned int* m_sq_head{nullptr};
+    unsigned int* m_sq_tail{nullptr};
+    unsigned int* m_sq_array{nullptr};
+    unsigned int* m_sq_flags{nullptr};
+    unsigned int  m_sq_mask{0};
+    unsigned int  m_sq_entries{0};
+    unsigned int  m_sqe_head{0};
+    unsigned int  m_sqe_tail{0};
+
+    unsigned int* m_cq_head{nullptr};
+    unsigned int* m_cq_tail{nullptr};
+    io_uring_cqe* m_cqes{nullptr};
+    unsigned int  m_cq_mask{0};
+
+    void*       m_buffer_ring{nullptr};
+    std::size_t m_buffer_ring_size{0};
+};
+
+//--------------------------------------------------------------------------------------------------
+
+template<class Handler>
+std::size_t IoUring::consumeCompletions(Handler&& handler, std::size_t max_count)
+{
+    std::atomic_ref<unsigned int>       cq_head{*m_cq_head};
+    const std::atomic_ref<unsigned int> cq_tail{*m_cq_tail};
+
+    unsigned int       head{cq_head.load(std::memory_order_relaxed)};
+    const unsigned int tail{cq_tail.load(std::memory_order_acquire)};
+
+    std::size_t consumed{0};
+    while (head != tail && consumed < max_count)
+    {
+        handler(m_cqes[head & m_cq_mask]);
+        ++head;
+        ++consumed;
+    }
+
+    cq_head.store(head, std::memory_order_release);
+    return consumed;
+}
+}  // namespace server
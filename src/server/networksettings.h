@@ -0,0 +1,18 @@
+#pragma once
+
+// system includes
+#include <cstddef>
+
+// local includes
+
+//--------------------------------------------------------------------------------------------------
+
+namespace server
+{
+struct NetworkSettings
+{
+    bool        m_segmentation_offload{false};
+    bool        m_io_uring{false};
+    std::size_t m_workers{1};
+};
+}  // namespace server
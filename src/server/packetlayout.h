@@ -0,0 +1,180 @@
+#pragma once
+
+// system includes
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+// local includes
+
+//--------------------------------------------------------------------------------------------------
+
+namespace server
+{
+// Value that is stored as little-endian bytes. Since it only consists of bytes, it has no alignment requirements and
+// the packet layouts below do not get any padding.
+template<class T>
+class LittleEndian final
+{
+public:
+    LittleEndian& operator=(T value)
+    {
+        auto bytes{std::bit_cast<std::array<std::uint8_t, sizeof(T)>>(value)};
+        if constexpr (std::endian::native == std::endian::big)
+        {
+            std::reverse(std::begin(bytes), std::end(bytes));
+        }
+
+        m_bytes = bytes;
+        return *this;
+    }
+
+    T get() const
+    {
+        auto bytes{m_bytes};
+        if constexpr (std::endian::native == std::endian::big)
+        {
+            std::reverse(std::begin(bytes), std::end(bytes));
+        }
+
+        return std::bit_cast<T>(bytes);
+    }
+
+private:
+    std::array<std::uint8_t, sizeof(T)> m_bytes;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+struct DsuHeader
+{
+    std::array<std::uint8_t, 4> m_magic;
+    LittleEndian<std::uint16_t> m_protocol_version;
+    LittleEndian<std::uint16_t> m_packet_size;  // Size of the msg type and the payload
+    LittleEndian<std::uint32_t> m_crc32;
+    LittleEndian<std::uint32_t> m_id;
+    LittleEndian<std::uint32_t> m_msg_type;
+};
+
+static_assert(offsetof(DsuHeader, m_packet_size) == 6);
+static_assert(offsetof(DsuHeader, m_crc32) == 8);
+static_assert(offsetof(DsuHeader, m_id) == 12);
+static_assert(offsetof(DsuHeader, m_msg_type) == 16);
+static_assert(sizeof(DsuHeader) == 20);
+
+//--------------------------------------------------------------------------------------------------
+
+struct ControllerHeader
+{
+    std::uint8_t                m_slot;
+    std::uint8_t                m_state;
+    std::uint8_t                m_model;
+    std::uint8_t                m_connection_type;
+    std::array<std::uint8_t, 6> m_mac;
+    std::uint8_t                m_battery;
+};
+
+static_assert(offsetof(ControllerHeader, m_mac) == 4);
+static_assert(sizeof(ControllerHeader) == 11);
+
+//--------------------------------------------------------------------------------------------------
+
+struct TouchLayout
+{
+    std::uint8_t                m_active;
+    std::uint8_t                m_id;
+    LittleEndian<std::uint16_t> m_x;
+    LittleEndian<std::uint16_t> m_y;
+};
+
+static_assert(sizeof(TouchLayout) == 6);
+
+//--------------------------------------------------------------------------------------------------
+
+struct VersionResponseLayout
+{
+    DsuHeader                   m_header;
+    LittleEndian<std::uint32_t> m_protocol_version;
+};
+
+static_assert(sizeof(VersionResponseLayout) == 24);
+
+//--------------------------------------------------------------------------------------------------
+
+struct ListPortsResponseLayout
+{
+    DsuHeader        m_header;
+    ControllerHeader m_controller;
+    std::uint8_t     m_zero;
+};
+
+static_assert(sizeof(ListPortsResponseLayout) == 32);
+
+//--------------------------------------------------------------------------------------------------
+
+struct PadDataResponseLayout
+{
+    DsuHeader                          m_header;
+    ControllerHeader                   m_controller;
+    std::uint8_t                       m_connected;
+    LittleEndian<std::uint32_t>        m_packet_counter;
+    std::uint8_t                       m_buttons_a;
+    std::uint8_t                       m_buttons_b;
+    std::uint8_t                       m_guide;
+    std::uint8_t                       m_touchpad;
+    std::uint8_t                       m_left_stick_x;
+    std::uint8_t                       m_left_stick_y;
+    std::uint8_t                       m_right_stick_x;
+    std::uint8_t                       m_right_stick_y;
+    std::uint8_t                       m_dpad_left;
+    std::uint8_t                       m_dpad_down;
+    std::uint8_t                       m_dpad_right;
+    std::uint8_t                       m_dpad_up;
+    std::uint8_t                       m_x;
+    std::uint8_t                       m_a;
+    std::uint8_t                       m_b;
+    std::uint8_t                       m_y;
+    std::uint8_t                       m_right_shoulder;
+    std::uint8_t                       m_left_shoulder;
+    std::uint8_t                       m_right_trigger;
+    std::uint8_t                       m_left_trigger;
+    std::array<TouchLayout, 2>         m_touches;
+    LittleEndian<std::uint64_t>        m_motion_ts;
+    std::array<LittleEndian<float>, 3> m_accel;
+    std::array<LittleEndian<float>, 3> m_gyro;
+};
+
+static_assert(offsetof(PadDataResponseLayout, m_controller) == 20);
+static_assert(offsetof(PadDataResponseLayout, m_packet_counter) == 32);
+static_assert(offsetof(PadDataResponseLayout, m_buttons_a) == 36);
+static_assert(offsetof(PadDataResponseLayout, m_touches) == 56);
+static_assert(offsetof(PadDataResponseLayout, m_motion_ts) == 68);
+static_assert(offsetof(PadDataResponseLayout, m_accel) == 76);
+static_assert(offsetof(PadDataResponseLayout, m_gyro) == 88);
+static_assert(sizeof(PadDataResponseLayout) == 100);
+
+//--------------------------------------------------------------------------------------------------
+
+struct ListPortsRequestLayout
+{
+    DsuHeader                   m_header;
+    LittleEndian<std::int32_t>  m_request_size;
+    std::array<std::uint8_t, 4> m_indexes;
+};
+
+static_assert(offsetof(ListPortsRequestLayout, m_indexes) == 24);
+
+//--------------------------------------------------------------------------------------------------
+
+struct PadDataRequestLayout
+{
+    DsuHeader                   m_header;
+    std::uint8_t                m_flags;
+    std::uint8_t                m_slot;
+    std::array<std::uint8_t, 6> m_mac;
+};
+
+static_assert(sizeof(PadDataRequestLayout) == 28);
+}  // namespace server
@@ -0,0 +1,169 @@
+// class header include
+#include "paddatamailbox.h"
+
+// system includes
+#include <boost/asio/post.hpp>
+#include <new>
+#include <span>
+
+// local includes
+#include "shared/coroutines.h"
+
+//--------------------------------------------------------------------------------------------------
+
+namespace
+{
+constexpr std::uint8_t IMMEDIATE_FLAG{1u << 4};
+
+//--------------------------------------------------------------------------------------------------
+
+// Hands out the single storage block of the mailbox for the queued wakeup handler
+template<class T>
+class WakeupAllocator final
+{
+public:
+    using value_type = T;
+
+    explicit WakeupAllocator(std::span<std::byte> storage)
+        : m_storage{storage}
+    {
+    }
+
+    template<class U>
+    WakeupAllocator(const WakeupAllocator<U>& other)
+        : m_storage{other.m_storage}
+    {
+    }
+
+    T* allocate(std::size_t count)
+    {
+        // Not expected to happen, but falls back to the heap in case the handler does not fit
+        if (sizeof(T) * count > m_storage.size())
+        {
+            return static_cast<T*>(::operator new(sizeof(T) * count));
+        }
+        return static_cast<T*>(static_cast<void*>(m_storage.data()));
+    }
+
+    void deallocate(T* pointer, std::size_t count)
+    {
+        if (sizeof(T) * count > m_storage.size())
+        {
+            ::operator delete(pointer);
+        }
+    }
+
+    template<class U>
+    bool operator==(const WakeupAllocator<U>& other) const
+    {
+        return m_storage.data() == other.m_storage.data();
+    }
+
+private:
+    template<class U>
+    friend class WakeupAllocator;
+
+    std::span<std::byte> m_storage;
+};
+}  // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+namespace server
+{
+PadDataMailbox::PadDataMailbox(boost::asio::io_context& io_context)
+    : m_io_context{io_context}
+    , m_wakeup_timer{io_context, boost::asio::steady_timer::time_point::max()}
+{
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void PadDataMailbox::post(std::uint8_t index, shared::UpdatePriority priority)
+{
+    BOOST_ASSERT(index < 4);
+    const bool         is_immediate{priority == shared::UpdatePriority::Immediate};
+    const std::uint8_t bits{static_cast<std::uint8_t>((1u << index) | (is_immediate ? IMMEDIATE_FLAG : 0u))};
+
+    // The sender can only be waiting for this update if it is the first one, or the first one with immediate priority
+    // while it waits for the tick. Otherwise the wakeup has already been queued by an earlier update.
+    const auto previous{m_posted.fetch_or(bits)};
+    if (previous != 0 && (!is_immediate || (previous & IMMEDIATE_FLAG) != 0))
+    {
+        return;
+    }
+
+    if (m_wakeup_queued.exchange(true))
+    {
+        return;
+    }
+
+    struct WakeupHandler
+    {
+        using allocator_type = WakeupAllocator<void>;
+
+        allocator_type get_allocator() const
+        {
+            return allocator_type{m_mailbox->m_wakeup_storage};
+        }
+
+        void operator()() const
+        {
+            m_mailbox->wakeUp();
+        }
+
+        PadDataMailbox* m_mailbox;
+    };
+    boost::asio::post(m_io_context, WakeupHandler{this});
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool PadDataMailbox::hasUpdates() const
+{
+    return m_posted.load() != 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool PadDataMailbox::hasImmediateUpdate() const
+{
+    return (m_posted.load() & IMMEDIATE_FLAG) != 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+boost::asio::awaitable<std::tuple<boost::system::error_code>>
+    PadDataMailbox::waitForWakeup(std::chrono::steady_clock::time_point time_point)
+{
+    // The wakeup cancels the wait
+    m_wakeup_timer.expires_at(time_point);
+    return m_wakeup_timer.async_wait(shared::use_nothrow_awaitable);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+shared::PadIndexSet PadDataMailbox::take()
+{
+    const auto  posted{m_posted.exchange(0)};
+    shared::PadIndexSet updated_indexes;
+    for (std::uint8_t index = 0; index < 4; ++index)
+    {
+        if ((posted & (1u << index)) != 0)
+        {
+            updated_indexes.insert(index);
+        }
+    }
+    return updated_indexes;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void PadDataMailbox::wakeUp()
+{
+    // The flag is cleared before checking for the updates (after the wakeup), so that an update posted in the
+    // meantime queues another wakeup
+    m_wakeup_queued.store(false);
+    m_wakeup_timer.cancel();
+}
+}  // namespace server
@@ -0,0 +1,64 @@
+#pragma once
+
+// system includes
+#include <array>
+#include <atomic>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/move/core.hpp>
+#include <boost/system/error_code.hpp>
+#include <cstddef>
+#include <tuple>
+
+// local includes
+#include "shared/gamepaddata.h"
+#include "shared/padindexset.h"
+
+//--------------------------------------------------------------------------------------------------
+
+namespace server
+{
+// Hands the updated pad indexes from the input loop over to the sender coroutine. Only the indexes are stored, so if
+// the sender falls behind, it simply sends the latest data of the pad instead of every intermediate state.
+//
+// The updates with immediate priority cut the wait for the next broadcast tick short (see `hasImmediateUpdate`).
+//
+// The indexes are posted lock-free from the input thread. The sender is only woken up when it might be waiting for
+// the update, with at most one wakeup handler queued at a time, which is constructed in place in the mailbox. So no
+// update allocates any memory.
+class PadDataMailbox final
+{
+    BOOST_MOVABLE_BUT_NOT_COPYABLE(PadDataMailbox)
+
+public:
+    explicit PadDataMailbox(boost::asio::io_context& io_context);
+
+    // Marks the pad as updated and wakes up the sender. Note: can be called from any thread
+    void post(std::uint8_t index, shared::UpdatePriority priority);
+
+    bool hasUpdates() const;
+    bool hasImmediateUpdate() const;
+
+    // Waits until the sender is woken up by an update (see `post`) or the time point has passed. The caller has to
+    // check the condition it is waiting for again afterwards.
+    //
+    // Note: this is not a coroutine itself, so that waiting only takes a single coroutine frame, which the recycling
+    // allocator of the io_context thread keeps reusing on the hot path.
+    boost::asio::awaitable<std::tuple<boost::system::error_code>>
+        waitForWakeup(std::chrono::steady_clock::time_point time_point = std::chrono::steady_clock::time_point::max());
+
+    // Returns all the updated pads since the last call, possibly none
+    shared::PadIndexSet take();
+
+private:
+    void wakeUp();
+
+    boost::asio::io_context&  m_io_context;
+    std::atomic<std::uint8_t> m_posted{0};  // Mask of the updated indexes and the immediate priority flag
+    std::atomic<bool>         m_wakeup_queued{false};
+    boost::asio::steady_timer m_wakeup_timer;
+
+    alignas(std::max_align_t) std::array<std::byte, 128> m_wakeup_storage;
+};
+}  // namespace server
@@ -0,0 +1,47 @@
+// class header include
+#include "responsecache.h"
+
+// system includes
+#include <boost/assert.hpp>
+#include <boost/log/trivial.hpp>
+
+// local includes
+
+//--------------------------------------------------------------------------------------------------
+
+namespace server
+{
+ResponseCache::ResponseCache(std::uint32_t server_id, const shared::GamepadDataSnapshots& gamepad_data)
+    : m_server_id{server_id}
+    , m_gamepad_data{gamepad_data}
+{
+    serialise(VersionResponse{}, m_server_id, m_version_response);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::span<const std::uint8_t, VERSION_RESPONSE_SIZE> ResponseCache::getVersionResponse() const
+{
+    return m_version_response;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::span<const std::uint8_t, LIST_PORTS_RESPONSE_SIZE> ResponseCache::getListPortsResponse(std::uint8_t index)
+{
+    BOOST_ASSERT(index < 4);
+
+    // Note: the generation is read before the pad data, which is then at least as new as the generation
+    const auto port_info_generation{m_gamepad_data.getPortInfoGeneration(index)};
+    if (m_list_ports_generations[index] != port_info_generation)
+    {
+        BOOST_LOG_TRIVIAL(debug) << "Rebuilding list ports response of pad " << static_cast<int>(index)
+                                 << " for port info generation " << port_info_generation;
+
+        serialise(ListPortsResponse{index, m_gamepad_data.read(index)}, m_server_id, m_list_ports_responses[index]);
+        m_list_ports_generations[index] = port_info_generation;
+    }
+
+    return m_list_ports_responses[index];
+}
+}  // namespace server
@@ -0,0 +1,37 @@
+#pragma once
+
+// system includes
+#include <boost/move/core.hpp>
+#include <optional>
+
+// local includes
+#include "serialiser.h"
+#include "shared/gamepaddatasnapshots.h"
+
+//--------------------------------------------------------------------------------------------------
+
+namespace server
+{
+// Keeps the serialised version and list ports responses around, since they only change together with the port info.
+// The list ports response of a pad is rebuilt lazily once the port info generation of the pad changes.
+class ResponseCache final
+{
+    BOOST_MOVABLE_BUT_NOT_COPYABLE(ResponseCache)
+
+public:
+    explicit ResponseCache(std::uint32_t server_id, const shared::GamepadDataSnapshots& gamepad_data);
+
+    std::span<const std::uint8_t, VERSION_RESPONSE_SIZE>    getVersionResponse() const;
+    std::span<const std::uint8_t, LIST_PORTS_RESPONSE_SIZE> getListPortsResponse(std::uint8_t index);
+
+private:
+    using ListPortsResponses   = std::array<std::array<std::uint8_t, LIST_PORTS_RESPONSE_SIZE>, 4>;
+    using ListPortsGenerations = std::array<std::optional<std::uint64_t>, 4>;
+
+    std::uint32_t                                   m_server_id;
+    const shared::GamepadDataSnapshots&             m_gamepad_data;
+    std::array<std::uint8_t, VERSION_RESPONSE_SIZE> m_version_response;
+    ListPortsResponses                              m_list_ports_responses;
+    ListPortsGenerations                            m_list_ports_generations;
+};
+}  // namespace server
@@ -2,10 +2,13 @@
 #include "serialiser.h"
 
 // system includes
-#include <iterator>
+#include <array>
+#include <cstring>
 
 // local includes
 #include "common.h"
+#include "crc32.h"
+#include "packetlayout.h"
 
 //--------------------------------------------------------------------------------------------------
 
@@ -13,77 +16,86 @@ namespace server
 {
 namespace
 {
-std::vector<std::uint8_t> finalizeResponse(const std::vector<std::uint8_t>& payload, std::uint32_t server_id,
-                                           DsuMsgType msg_type)
+static_assert(sizeof(VersionResponseLayout) == VERSION_RESPONSE_SIZE);
+static_assert(sizeof(ListPortsResponseLayout) == LIST_PORTS_RESPONSE_SIZE);
+static_assert(sizeof(PadDataResponseLayout) == PAD_DATA_RESPONSE_SIZE);
+
+//--------------------------------------------------------------------------------------------------
+
+// CRC32 is linear, so flipping some bits of the message flips the same bits of the checksum no matter what the rest
+// of the message is. Each table holds the checksum difference caused by one byte of the packet counter (followed by
+// the rest of the packet), which allows updating the counter without recalculating the whole CRC32.
+using PacketCounterCrcTables = std::array<std::array<std::uint32_t, 256>, 4>;
+
+PacketCounterCrcTables makePacketCounterCrcTables()
 {
-    std::size_t               index{0};
-    std::vector<std::uint8_t> data(20, 0);
+    constexpr std::size_t counter_offset{offsetof(PadDataResponseLayout, m_packet_counter)};
 
-    // Header
-    writeUInt8(data, index, 'D');
-    writeUInt8(data, index, 'S');
-    writeUInt8(data, index, 'U');
-    writeUInt8(data, index, 'S');
-    writeUInt16LE(data, index, getProtocolVersion());
-    writeUInt16LE(data, index, static_cast<std::uint16_t>(payload.size()) + 4);
-    writeUInt32LE(data, index, 0x00 /* Reserved for CRC32 */);
-    writeUInt32LE(data, index, server_id);
+    const std::array<std::uint8_t, PAD_DATA_RESPONSE_SIZE> zeros{};
+    PacketCounterCrcTables                                 tables{};
+    for (std::size_t byte_index = 0; byte_index < tables.size(); ++byte_index)
+    {
+        // The difference only depends on the changed bits, so it is taken between the byte (followed by zeros) and an
+        // all zero message of the same length
+        const std::size_t                   rest_size{PAD_DATA_RESPONSE_SIZE - counter_offset - byte_index - 1};
+        const std::span<const std::uint8_t> rest{zeros.data(), rest_size};
+        const std::uint32_t                 unchanged_crc{calculateCrc32(rest, calculateCrc32({zeros.data(), 1}))};
+        for (std::size_t value = 0; value < tables[byte_index].size(); ++value)
+        {
+            const std::uint8_t byte{static_cast<std::uint8_t>(value)};
+            tables[byte_index][value] = calculateCrc32(rest, calculateCrc32({&byte, 1})) ^ unchanged_crc;
+        }
+    }
+
+    return tables;
+}
 
-    // Msg type (adds 4 bytes to size)
-    writeUInt32LE(data, index, enumToValue(msg_type));
+//--------------------------------------------------------------------------------------------------
 
-    // Payload
-    std::copy(std::begin(payload), std::end(payload), std::back_inserter(data));
+template<class Layout>
+void finalizeResponse(Layout& layout, std::uint32_t server_id, DsuMsgType msg_type,
+                      std::span<std::uint8_t, sizeof(Layout)> data)
+{
+    auto& header{layout.m_header};
+    header.m_magic            = {'D', 'S', 'U', 'S'};
+    header.m_protocol_version = getProtocolVersion();
+    header.m_packet_size      = static_cast<std::uint16_t>(sizeof(Layout) - offsetof(DsuHeader, m_msg_type));
+    header.m_crc32            = 0x00;
+    header.m_id               = server_id;
+    header.m_msg_type         = enumToValue(msg_type);
 
     // Calculate CRC32
-    index = 8;
-    writeUInt32LE(data, index, calculateCrc32(data));
+    header.m_crc32 = calculateCrc32({reinterpret_cast<const std::uint8_t*>(&layout), sizeof(Layout)});
 
-    return data;
+    std::memcpy(data.data(), &layout, sizeof(Layout));
 }
 
 //--------------------------------------------------------------------------------------------------
 
-void serialiseGamepadHeader(const std::optional<shared::GamepadData>& gamepad_data, std::uint8_t pad_index,
-                            std::vector<std::uint8_t>& data, std::size_t& index)
+ControllerHeader serialiseGamepadHeader(const std::optional<shared::GamepadData>& gamepad_data, std::uint8_t pad_index)
 {
-    writeUInt8(data, index, pad_index);
-    if (gamepad_data)
-    {
-        writeUInt8(data, index, 0x02 /* connected */);
-        writeUInt8(data, index, gamepad_data->m_sensor.m_ts != 0 ? 0x02 : 0x00 /* gyro state */);
-        writeUInt8(data, index,
-                   gamepad_data->m_battery == shared::details::BatteryLevel::Wired ? 0x01 : 0x02 /* connection type */);
-    }
-    else
-    {
-        writeUInt8(data, index, 0x00 /* disconnected */);
-        writeUInt8(data, index, 0x00 /* no gyro yet */);
-        writeUInt8(data, index, 0x00 /* no connection type yet */);
-    }
-
     // This is a custom MAC address implementation, since SDL does not provide any. MAC is always mapped to the pad
     // index
-    writeUInt8(data, index, pad_index);
-    writeUInt8(data, index, 0x00);
-    writeUInt8(data, index, 0x00);
-    writeUInt8(data, index, 0x00);
-    writeUInt8(data, index, 0x00);
-    writeUInt8(data, index, 0x00);
+    ControllerHeader header{};
+    header.m_slot = pad_index;
+    header.m_mac  = {pad_index, 0x00, 0x00, 0x00, 0x00, 0x00};
 
     if (gamepad_data)
     {
-        writeUInt8(data, index, enumToValue(gamepad_data->m_battery));
-    }
-    else
-    {
-        writeUInt8(data, index, 0x00 /* no battery yet */);
+        header.m_state = 0x02 /* connected */;
+        header.m_model = gamepad_data->m_sensor.m_ts != 0 ? 0x02 : 0x00 /* gyro state */;
+        header.m_connection_type =
+            gamepad_data->m_battery == shared::details::BatteryLevel::Wired ? 0x01 : 0x02 /* connection type */;
+        header.m_battery = enumToValue(gamepad_data->m_battery);
     }
+
+    // Otherwise disconnected, no gyro, connection type or battery yet
+    return header;
 }
 
 //--------------------------------------------------------------------------------------------------
 
-void serialiseButtonFlagsA(const shared::GamepadData& gamepad_data, std::vector<std::uint8_t>& data, std::size_t& index)
+std::uint8_t serialiseButtonFlagsA(const shared::GamepadData& gamepad_data)
 {
     std::uint8_t flag{0};
     if (gamepad_data.m_dpad.m_left)
@@ -104,12 +116,12 @@ void serialiseButtonFlagsA(const shared::GamepadData& gamepad_data, std::vector<
     if (gamepad_data.m_special.m_back)
         flag |= 0x01;
 
-    writeUInt8(data, index, flag);
+    return flag;
 }
 
 //--------------------------------------------------------------------------------------------------
 
-void serialiseButtonFlagsB(const shared::GamepadData& gamepad_data, std::vector<std::uint8_t>& data, std::size_t& index)
+std::uint8_t serialiseButtonFlagsB(const shared::GamepadData& gamepad_data)
 {
     std::uint8_t flag{0};
     if (gamepad_data.m_abxy.m_x)
@@ -130,109 +142,121 @@ void serialiseButtonFlagsB(const shared::GamepadData& gamepad_data, std::vector<
     if (gamepad_data.m_trigger.m_left == 0xFF)
         flag |= 0x01;
 
-    writeUInt8(data, index, flag);
+    return flag;
 }
 
 //--------------------------------------------------------------------------------------------------
 
-void serialiseTouch(const shared::details::Touch& touch, std::vector<std::uint8_t>& data, std::size_t& index)
+TouchLayout serialiseTouch(const shared::details::Touch& touch)
 {
-    writeUInt8(data, index, touch.m_touched ? 0x01 : 0x00);
-    writeUInt8(data, index, touch.m_id);
-    writeUInt16LE(data, index, touch.m_x);
-    writeUInt16LE(data, index, touch.m_y);
+    TouchLayout layout{};
+    layout.m_active = touch.m_touched ? 0x01 : 0x00;
+    layout.m_id     = touch.m_id;
+    layout.m_x      = touch.m_x;
+    layout.m_y      = touch.m_y;
+    return layout;
 }
 }  // namespace
 
 //--------------------------------------------------------------------------------------------------
 
-std::vector<std::uint8_t> serialise(const VersionResponse&, std::uint32_t server_id)
+void serialise(const VersionResponse&, std::uint32_t server_id, std::span<std::uint8_t, VERSION_RESPONSE_SIZE> data)
 {
-    std::size_t               index{0};
-    std::vector<std::uint8_t> data(4, 0);
-
-    // Payload
-    writeUInt32LE(data, index, getProtocolVersion());
+    VersionResponseLayout layout{};
+    layout.m_protocol_version = getProtocolVersion();
 
-    return finalizeResponse(data, server_id, DsuMsgType::Version);
+    finalizeResponse(layout, server_id, DsuMsgType::Version, data);
 }
 
 //--------------------------------------------------------------------------------------------------
 
-std::vector<std::vector<std::uint8_t>> serialise(const ListPortsResponse& response, std::uint32_t server_id)
+void serialise(const ListPortsResponse& response, std::uint32_t server_id,
+               std::span<std::uint8_t, LIST_PORTS_RESPONSE_SIZE> data)
 {
-    std::vector<std::vector<std::uint8_t>> data_list;
-    for (const auto pad_index : response.m_requested_indexes)
-    {
-        std::size_t               index{0};
-        std::vector<std::uint8_t> data(12, 0);
-
-        serialiseGamepadHeader(response.m_gamepad_data[pad_index], pad_index, data, index);
-        writeUInt8(data, index, 0x00);  // Trailing 0 for some reason
-
-        data_list.push_back(finalizeResponse(data, server_id, DsuMsgType::ListPorts));
-    }
+    ListPortsResponseLayout layout{};
+    layout.m_controller = serialiseGamepadHeader(response.m_gamepad_data, response.m_pad_index);
+    layout.m_zero       = 0x00;  // Trailing 0 for some reason
 
-    return data_list;
+    finalizeResponse(layout, server_id, DsuMsgType::ListPorts, data);
 }
 
 //--------------------------------------------------------------------------------------------------
 
-std::vector<std::uint8_t> serialise(const PadDataResponse& response, std::uint32_t server_id)
+void serialise(const PadDataResponse& response, std::uint32_t server_id,
+               std::span<std::uint8_t, PAD_DATA_RESPONSE_SIZE> data)
 {
-    std::size_t               index{0};
-    std::vector<std::uint8_t> data(80, 0);
-
-    serialiseGamepadHeader(response.m_gamepad_data, response.m_pad_index, data, index);
-
-    writeUInt8(data, index, response.m_gamepad_data ? 0x01 : 0x00);
-    writeUInt32LE(data, index, response.m_packet_counter);
+    PadDataResponseLayout layout{};
+    layout.m_controller     = serialiseGamepadHeader(response.m_gamepad_data, response.m_pad_index);
+    layout.m_connected      = response.m_gamepad_data ? 0x01 : 0x00;
+    layout.m_packet_counter = 0x00;  // See updatePacketCounter
 
     // In case we have no data, the rest of fields can be left zero-ed out
     if (response.m_gamepad_data)
     {
         const auto& gamepad_data{*response.m_gamepad_data};
 
-        serialiseButtonFlagsA(gamepad_data, data, index);
-        serialiseButtonFlagsB(gamepad_data, data, index);
+        layout.m_buttons_a = serialiseButtonFlagsA(gamepad_data);
+        layout.m_buttons_b = serialiseButtonFlagsB(gamepad_data);
 
-        writeUInt8(data, index, gamepad_data.m_special.m_guide ? 0x01 : 0x00);
-        writeUInt8(data, index, gamepad_data.m_touchpad.m_pressed ? 0x01 : 0x00);
+        layout.m_guide    = gamepad_data.m_special.m_guide ? 0x01 : 0x00;
+        layout.m_touchpad = gamepad_data.m_touchpad.m_pressed ? 0x01 : 0x00;
 
-        writeUInt8(data, index, gamepad_data.m_left_stick.m_x);
-        writeUInt8(data, index, gamepad_data.m_left_stick.m_y);
+        layout.m_left_stick_x = gamepad_data.m_left_stick.m_x;
+        layout.m_left_stick_y = gamepad_data.m_left_stick.m_y;
 
-        writeUInt8(data, index, gamepad_data.m_right_stick.m_x);
-        writeUInt8(data, index, gamepad_data.m_right_stick.m_y);
+        layout.m_right_stick_x = gamepad_data.m_right_stick.m_x;
+        layout.m_right_stick_y = gamepad_data.m_right_stick.m_y;
 
-        writeUInt8(data, index, gamepad_data.m_dpad.m_left ? 0xFF : 0x00);
-        writeUInt8(data, index, gamepad_data.m_dpad.m_down ? 0xFF : 0x00);
-        writeUInt8(data, index, gamepad_data.m_dpad.m_right ? 0xFF : 0x00);
-        writeUInt8(data, index, gamepad_data.m_dpad.m_up ? 0xFF : 0x00);
+        layout.m_dpad_left  = gamepad_data.m_dpad.m_left ? 0xFF : 0x00;
+        layout.m_dpad_down  = gamepad_data.m_dpad.m_down ? 0xFF : 0x00;
+        layout.m_dpad_right = gamepad_data.m_dpad.m_right ? 0xFF : 0x00;
+        layout.m_dpad_up    = gamepad_data.m_dpad.m_up ? 0xFF : 0x00;
 
-        writeUInt8(data, index, gamepad_data.m_abxy.m_x ? 0xFF : 0x00);
-        writeUInt8(data, index, gamepad_data.m_abxy.m_a ? 0xFF : 0x00);
-        writeUInt8(data, index, gamepad_data.m_abxy.m_b ? 0xFF : 0x00);
-        writeUInt8(data, index, gamepad_data.m_abxy.m_y ? 0xFF : 0x00);
+        layout.m_x = gamepad_data.m_abxy.m_x ? 0xFF : 0x00;
+        layout.m_a = gamepad_data.m_abxy.m_a ? 0xFF : 0x00;
+        layout.m_b = gamepad_data.m_abxy.m_b ? 0xFF : 0x00;
+        layout.m_y = gamepad_data.m_abxy.m_y ? 0xFF : 0x00;
 
-        writeUInt8(data, index, gamepad_data.m_shoulder.m_right ? 0xFF : 0x00);
-        writeUInt8(data, index, gamepad_data.m_shoulder.m_left ? 0xFF : 0x00);
+        layout.m_right_shoulder = gamepad_data.m_shoulder.m_right ? 0xFF : 0x00;
+        layout.m_left_shoulder  = gamepad_data.m_shoulder.m_left ? 0xFF : 0x00;
 
-        writeUInt8(data, index, gamepad_data.m_trigger.m_right);
-        writeUInt8(data, index, gamepad_data.m_trigger.m_left);
+        layout.m_right_trigger = gamepad_data.m_trigger.m_right;
+        layout.m_left_trigger  = gamepad_data.m_trigger.m_left;
 
-        serialiseTouch(gamepad_data.m_touchpad.m_first_touch, data, index);
-        serialiseTouch(gamepad_data.m_touchpad.m_second_touch, data, index);
+        layout.m_touches = {serialiseTouch(gamepad_data.m_touchpad.m_first_touch),
+                            serialiseTouch(gamepad_data.m_touchpad.m_second_touch)};
 
-        writeUInt64LE(data, index, gamepad_data.m_sensor.m_ts);
-        writeFloatLE(data, index, gamepad_data.m_sensor.m_accel.m_x);
-        writeFloatLE(data, index, gamepad_data.m_sensor.m_accel.m_y);
-        writeFloatLE(data, index, gamepad_data.m_sensor.m_accel.m_z);
-        writeFloatLE(data, index, gamepad_data.m_sensor.m_gyro.m_pitch);
-        writeFloatLE(data, index, gamepad_data.m_sensor.m_gyro.m_yaw);
-        writeFloatLE(data, index, gamepad_data.m_sensor.m_gyro.m_roll);
+        layout.m_motion_ts = gamepad_data.m_sensor.m_ts;
+        layout.m_accel[0]  = gamepad_data.m_sensor.m_accel.m_x;
+        layout.m_accel[1]  = gamepad_data.m_sensor.m_accel.m_y;
+        layout.m_accel[2]  = gamepad_data.m_sensor.m_accel.m_z;
+        layout.m_gyro[0]   = gamepad_data.m_sensor.m_gyro.m_pitch;
+        layout.m_gyro[1]   = gamepad_data.m_sensor.m_gyro.m_yaw;
+        layout.m_gyro[2]   = gamepad_data.m_sensor.m_gyro.m_roll;
     }
 
-    return finalizeResponse(data, server_id, DsuMsgType::PadData);
+    finalizeResponse(layout, server_id, DsuMsgType::PadData, data);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void updatePacketCounter(std::span<std::uint8_t, PAD_DATA_RESPONSE_SIZE> data, std::uint32_t packet_counter)
+{
+    static const PacketCounterCrcTables tables{makePacketCounterCrcTables()};
+
+    constexpr std::size_t       counter_offset{offsetof(PadDataResponseLayout, m_packet_counter)};
+    constexpr std::size_t       crc_offset{offsetof(PadDataResponseLayout, m_header) + offsetof(DsuHeader, m_crc32)};
+    LittleEndian<std::uint32_t> counter;
+    LittleEndian<std::uint32_t> crc;
+    std::memcpy(&counter, data.data() + counter_offset, sizeof(counter));
+    std::memcpy(&crc, data.data() + crc_offset, sizeof(crc));
+
+    const std::uint32_t changed_bits{counter.get() ^ packet_counter};
+    crc = crc.get() ^ tables[0][changed_bits & 0xFF] ^ tables[1][(changed_bits >> 8) & 0xFF]
+          ^ tables[2][(changed_bits >> 16) & 0xFF] ^ tables[3][changed_bits >> 24];
+    counter = packet_counter;
+
+    std::memcpy(data.data() + counter_offset, &counter, sizeof(counter));
+    std::memcpy(data.data() + crc_offset, &crc, sizeof(crc));
 }
 }  // namespace server
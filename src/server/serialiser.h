@@ -2,8 +2,7 @@
 
 // system includes
 #include <cstdint>
-#include <set>
-#include <vector>
+#include <span>
 
 // local includes
 #include "shared/gamepaddata.h"
@@ -12,6 +11,14 @@
 
 namespace server
 {
+// Full packet sizes of the responses, header included
+constexpr std::size_t VERSION_RESPONSE_SIZE{24};
+constexpr std::size_t LIST_PORTS_RESPONSE_SIZE{32};
+constexpr std::size_t PAD_DATA_RESPONSE_SIZE{100};
+constexpr std::size_t MAX_RESPONSE_SIZE{PAD_DATA_RESPONSE_SIZE};
+
+//--------------------------------------------------------------------------------------------------
+
 struct VersionResponse
 {
 };
@@ -20,8 +27,8 @@ struct VersionResponse
 
 struct ListPortsResponse
 {
-    const std::set<std::uint8_t>&       m_requested_indexes;
-    const shared::GamepadDataContainer& m_gamepad_data;
+    const std::uint8_t                        m_pad_index;
+    const std::optional<shared::GamepadData>& m_gamepad_data;
 };
 
 //--------------------------------------------------------------------------------------------------
@@ -29,20 +36,27 @@ struct ListPortsResponse
 struct PadDataResponse
 {
     const std::uint8_t                        m_pad_index;
-    const std::uint32_t                       m_client_id;
-    const std::uint32_t                       m_packet_counter;
     const std::optional<shared::GamepadData>& m_gamepad_data;
 };
 
 //--------------------------------------------------------------------------------------------------
 
-std::vector<std::uint8_t> serialise(const VersionResponse& response, std::uint32_t server_id);
+void serialise(const VersionResponse& response, std::uint32_t server_id,
+               std::span<std::uint8_t, VERSION_RESPONSE_SIZE> data);
+
+//--------------------------------------------------------------------------------------------------
+
+void serialise(const ListPortsResponse& response, std::uint32_t server_id,
+               std::span<std::uint8_t, LIST_PORTS_RESPONSE_SIZE> data);
 
 //--------------------------------------------------------------------------------------------------
 
-std::vector<std::vector<std::uint8_t>> serialise(const ListPortsResponse& response, std::uint32_t server_id);
+// Note: the packet counter is the only field that differs between the clients, so it is left zeroed out here and
+// should be set via `updatePacketCounter` on the copies of the serialised response.
+void serialise(const PadDataResponse& response, std::uint32_t server_id,
+               std::span<std::uint8_t, PAD_DATA_RESPONSE_SIZE> data);
 
 //--------------------------------------------------------------------------------------------------
 
-std::vector<std::uint8_t> serialise(const PadDataResponse& response, std::uint32_t server_id);
+void updatePacketCounter(std::span<std::uint8_t, PAD_DATA_RESPONSE_SIZE> data, std::uint32_t packet_counter);
 }  // namespace server
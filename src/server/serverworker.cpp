@@ -0,0 +1,146 @@
+// class header include
+#include "serverworker.h"
+
+// system includes
+#include <boost/asio/co_spawn.hpp>
+#include <cerrno>
+#include <stdexcept>
+#include <string>
+
+#if defined(__linux__)
+    #include <sys/socket.h>
+#endif
+
+// local includes
+#include "communication.h"
+#include "shared/coroutines.h"
+#include "unreachableclients.h"
+
+//--------------------------------------------------------------------------------------------------
+
+namespace
+{
+boost::asio::ip::udp::socket openSocket(boost::asio::io_context& io_context, std::uint16_t port,
+                                        [[maybe_unused]] bool reuse_port)
+{
+    boost::asio::ip::udp::socket socket{io_context};
+    socket.open(boost::asio::ip::udp::v4());
+
+#if defined(__linux__)
+    if (reuse_port)
+    {
+        const int enabled{1};
+        if (::setsockopt(socket.native_handle(), SOL_SOCKET, SO_REUSEPORT, &enabled, sizeof(enabled)) != 0)
+        {
+            throw boost::system::system_error{errno, boost::system::system_category(), "setsockopt(SO_REUSEPORT)"};
+        }
+    }
+#endif
+
+    socket.bind({boost::asio::ip::udp::v4(), port});
+    return socket;
+}
+}  // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+namespace server
+{
+void ensurePortIsFree(std::uint16_t port)
+{
+    // A socket without `SO_REUSEPORT` can not share the port with anyone, so its bind fails if another process holds
+    // the port (with or without the option). Note: another process can still take the port between this check and the
+    // bind of the workers, it only guards against the common case of starting a second instance.
+    boost::asio::io_context      io_context{1};
+    boost::asio::ip::udp::socket probe{io_context};
+    probe.open(boost::asio::ip::udp::v4());
+
+    boost::system::error_code error;
+    probe.bind({boost::asio::ip::udp::v4(), port}, error);
+    if (error == boost::asio::error::address_in_use)
+    {
+        throw std::runtime_error{"Port " + std::to_string(port)
+                                 + " is already in use, is another instance of the server running?"};
+    }
+    if (error)
+    {
+        throw boost::system::system_error{error, "bind"};
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+ServerWorker::ServerWorker(std::uint32_t server_id, std::uint16_t port, bool reuse_port,
+                           const shared::GamepadDataSnapshots& gamepad_data, const NetworkSettings& network_settings,
+                           const ClientSettings& client_settings, const BroadcastSettings& broadcast_settings,
+                           std::function<void()> on_first_client)
+    : m_server_id{server_id}
+    , m_gamepad_data{gamepad_data}
+    , m_network_settings{network_settings}
+    , m_broadcast_settings{broadcast_settings}
+    , m_on_first_client{std::move(on_first_client)}
+    , m_io_context{1}
+    , m_socket{openSocket(m_io_context, port, reuse_port)}
+    , m_clients{client_settings}
+    , m_mailbox{m_io_context}
+    , m_pending_timer{m_io_context}
+{
+}
+
+//--------------------------------------------------------------------------------------------------
+
+boost::asio::io_context& ServerWorker::getIoContext()
+{
+    return m_io_context;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+boost::asio::ip::udp::endpoint ServerWorker::getLocalEndpoint() const
+{
+    return m_socket.local_endpoint();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void ServerWorker::notify(std::uint8_t index, shared::UpdatePriority priority)
+{
+    m_mailbox.post(index, priority);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::size_t ServerWorker::getNumberOfClients() const
+{
+    return m_clients.getNumberOfClients();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void ServerWorker::stop()
+{
+    m_io_context.stop();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void ServerWorker::run()
+{
+    boost::asio::co_spawn(
+        m_io_context,
+        listenAndRespond(m_server_id, m_gamepad_data, m_clients, m_socket, m_network_settings, m_on_first_client),
+        shared::exceptionHandler);
+    boost::asio::co_spawn(m_io_context,
+                          distributePadData(m_server_id, m_gamepad_data, m_clients, m_socket, m_network_settings,
+                                            m_broadcast_settings, m_mailbox, m_pending_timer),
+                          shared::exceptionHandler);
+    boost::asio::co_spawn(m_io_context,
+                          distributePendingPadData(m_server_id, m_gamepad_data, m_clients, m_socket,
+                                                   m_network_settings, m_pending_timer),
+                          shared::exceptionHandler);
+    boost::asio::co_spawn(m_io_context, expireInactiveClients(m_clients), shared::exceptionHandler);
+    boost::asio::co_spawn(m_io_context, evictUnreachableClients(m_clients, m_socket), shared::exceptionHandler);
+
+    m_io_context.run();
+}
+}  // namespace server
@@ -0,0 +1,67 @@
+#pragma once
+
+// system includes
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/move/core.hpp>
+#include <functional>
+
+// local includes
+#include "activeclients.h"
+#include "broadcastsettings.h"
+#include "clientsettings.h"
+#include "networksettings.h"
+#include "paddatamailbox.h"
+#include "shared/gamepaddatasnapshots.h"
+
+//--------------------------------------------------------------------------------------------------
+
+namespace server
+{
+// Throws if another process already holds the port. The workers set `SO_REUSEPORT` to share the port, which would also
+// let them silently share it with another instance of the server (that did the same), so this is checked beforehand.
+void ensurePortIsFree(std::uint16_t port);
+
+//--------------------------------------------------------------------------------------------------
+
+// A complete DSU server (its own thread, socket and clients) that serves the pad data snapshots.
+//
+// With multiple workers, the sockets share the port via `SO_REUSEPORT` (Linux only). The kernel then distributes the
+// clients between the sockets by their address and port, so each worker only ever sees and sends to its own share
+// of the clients and the fan-out of a pad update runs on all the workers in parallel.
+class ServerWorker final
+{
+    BOOST_MOVABLE_BUT_NOT_COPYABLE(ServerWorker)
+
+public:
+    explicit ServerWorker(std::uint32_t server_id, std::uint16_t port, bool reuse_port,
+                          const shared::GamepadDataSnapshots& gamepad_data, const NetworkSettings& network_settings,
+                          const ClientSettings& client_settings, const BroadcastSettings& broadcast_settings,
+                          std::function<void()> on_first_client);
+
+    boost::asio::io_context&       getIoContext();
+    boost::asio::ip::udp::endpoint getLocalEndpoint() const;  // Also reports the port picked by the OS for port 0
+
+    // Note: can be called from any thread
+    void        notify(std::uint8_t index, shared::UpdatePriority priority);
+    std::size_t getNumberOfClients() const;
+    void        stop();
+
+    // Runs the server on the calling thread until it is stopped
+    void run();
+
+private:
+    std::uint32_t                       m_server_id;
+    const shared::GamepadDataSnapshots& m_gamepad_data;
+    const NetworkSettings&              m_network_settings;
+    const BroadcastSettings&            m_broadcast_settings;
+    std::function<void()>               m_on_first_client;
+
+    boost::asio::io_context      m_io_context;
+    boost::asio::ip::udp::socket m_socket;
+    ActiveClients                m_clients;
+    PadDataMailbox               m_mailbox;
+    boost::asio::steady_timer    m_pending_timer;
+};
+}  // namespace server
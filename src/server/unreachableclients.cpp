@@ -0,0 +1,162 @@
+// class header include
+#include "unreachableclients.h"
+
+// system includes
+#include <array>
+#include <boost/log/trivial.hpp>
+#include <cerrno>
+#include <cstring>
+#include <optional>
+
+#if defined(__linux__)
+    #include <linux/errqueue.h>
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+#endif
+
+// local includes
+#include "shared/coroutines.h"
+
+//--------------------------------------------------------------------------------------------------
+
+namespace
+{
+#if defined(__linux__)
+bool enableErrorQueue(boost::asio::ip::udp::socket& socket)
+{
+    const bool is_v6{socket.local_endpoint().protocol() == boost::asio::ip::udp::v6()};
+    const int  enabled{1};
+    if (::setsockopt(socket.native_handle(), is_v6 ? IPPROTO_IPV6 : IPPROTO_IP, is_v6 ? IPV6_RECVERR : IP_RECVERR,
+                     &enabled, sizeof(enabled))
+        != 0)
+    {
+        const boost::system::error_code error{errno, boost::system::system_category()};
+        BOOST_LOG_TRIVIAL(warning) << "Failed to enable the socket error queue, unreachable clients will time out: ["
+                                   << error << "] " << error.message();
+        return false;
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::optional<boost::system::error_code> getIcmpError(msghdr& header)
+{
+    for (cmsghdr* control_header = CMSG_FIRSTHDR(&header); control_header != nullptr;
+         control_header          = CMSG_NXTHDR(&header, control_header))
+    {
+        const bool is_v4_error{control_header->cmsg_level == IPPROTO_IP && control_header->cmsg_type == IP_RECVERR};
+        const bool is_v6_error{control_header->cmsg_level == IPPROTO_IPV6
+                               && control_header->cmsg_type == IPV6_RECVERR};
+        if (!is_v4_error && !is_v6_error)
+        {
+            continue;
+        }
+
+        sock_extended_err error;
+        std::memcpy(&error, CMSG_DATA(control_header), sizeof(error));
+        if (error.ee_origin == SO_EE_ORIGIN_ICMP || error.ee_origin == SO_EE_ORIGIN_ICMP6)
+        {
+            return boost::system::error_code{static_cast<int>(error.ee_errno), boost::system::system_category()};
+        }
+    }
+
+    return std::nullopt;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void drainErrorQueue(server::ActiveClients& clients, boost::asio::ip::udp::socket& socket)
+{
+    // The control message holds a `sock_extended_err` followed by the address of the ICMP sender
+    alignas(cmsghdr) std::array<std::uint8_t, 256> control;
+    for (;;)
+    {
+        boost::asio::ip::udp::endpoint endpoint;
+        msghdr                         header{};
+
+        header.msg_name       = endpoint.data();
+        header.msg_namelen    = static_cast<socklen_t>(endpoint.capacity());
+        header.msg_control    = control.data();
+        header.msg_controllen = control.size();
+
+        if (::recvmsg(socket.native_handle(), &header, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+        {
+            const boost::system::error_code receive_error{errno, boost::system::system_category()};
+            if (receive_error == boost::asio::error::interrupted)
+            {
+                continue;
+            }
+
+            if (receive_error != boost::asio::error::would_block && receive_error != boost::asio::error::try_again)
+            {
+                BOOST_LOG_TRIVIAL(error) << "evictUnreachableClients::recvmsg: [" << receive_error << "] "
+                                         << receive_error.message();
+            }
+            return;
+        }
+
+        // The original destination of the datagram that has caused the error
+        endpoint.resize(header.msg_namelen);
+
+        const auto icmp_error{getIcmpError(header)};
+        if (!icmp_error || !server::isUnreachableError(*icmp_error))
+        {
+            continue;
+        }
+
+        BOOST_LOG_TRIVIAL(debug) << "Endpoint " << endpoint << " is unreachable: [" << *icmp_error << "] "
+                                 << icmp_error->message();
+        clients.removeEndpoint(endpoint);
+    }
+}
+#endif
+}  // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+namespace server
+{
+bool isUnreachableError(const boost::system::error_code& error)
+{
+#if !defined(__linux__)
+    if (error == boost::asio::error::connection_reset)
+    {
+        return true;
+    }
+#endif
+
+    return error == boost::asio::error::connection_refused || error == boost::asio::error::host_unreachable
+           || error == boost::asio::error::network_unreachable;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+boost::asio::awaitable<void> evictUnreachableClients([[maybe_unused]] ActiveClients&                clients,
+                                                     [[maybe_unused]] boost::asio::ip::udp::socket& socket)
+{
+#if defined(__linux__)
+    if (!enableErrorQueue(socket))
+    {
+        co_return;
+    }
+
+    for (;;)
+    {
+        const auto [wait_error] =
+            co_await socket.async_wait(boost::asio::ip::udp::socket::wait_error, shared::use_nothrow_awaitable);
+        if (wait_error)
+        {
+            BOOST_LOG_TRIVIAL(error) << "evictUnreachableClients::async_wait: [" << wait_error << "] "
+                                     << wait_error.message();
+            continue;
+        }
+
+        drainErrorQueue(clients, socket);
+    }
+#else
+    co_return;
+#endif
+}
+}  // namespace server
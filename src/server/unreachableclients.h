@@ -0,0 +1,26 @@
+#pragma once
+
+// system includes
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/system/error_code.hpp>
+
+// local includes
+#include "activeclients.h"
+
+//--------------------------------------------------------------------------------------------------
+
+namespace server
+{
+// Errors that are caused by an ICMP error (e.g. port unreachable once an emulator has exited) of a previously sent
+// datagram. On Linux the socket also returns these from the next send or receive call, even though they do not
+// belong to that call. Windows reports the port unreachable errors as a connection reset of the next receive call.
+bool isUnreachableError(const boost::system::error_code& error);
+
+//--------------------------------------------------------------------------------------------------
+
+// Removes the clients as soon as their endpoint is reported to be unreachable, instead of sending to them until they
+// time out. On Linux the ICMP errors are read (together with the original destination) from the socket error queue.
+// Other platforms report them from the receive calls instead, see `BatchReceiver::getUnreachableEndpoints`.
+boost::asio::awaitable<void> evictUnreachableClients(ActiveClients& clients, boost::asio::ip::udp::socket& socket);
+}  // namespace server
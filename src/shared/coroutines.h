@@ -0,0 +1,27 @@
+#pragma once
+
+// system includes
+#include <boost/asio/experimental/as_tuple.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <exception>
+
+// local includes
+
+//--------------------------------------------------------------------------------------------------
+
+namespace shared
+{
+// Completion token that returns the error code (as part of a tuple) instead of throwing it
+constexpr auto use_nothrow_awaitable{boost::asio::experimental::as_tuple(boost::asio::use_awaitable)};
+
+//--------------------------------------------------------------------------------------------------
+
+// Completion handler for `co_spawn` that rethrows the exception of the coroutine from the `run` of its io_context
+inline void exceptionHandler(std::exception_ptr exception)
+{
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+}
+}  // namespace shared
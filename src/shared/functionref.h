@@ -0,0 +1,46 @@
+#pragma once
+
+// system includes
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// local includes
+
+//--------------------------------------------------------------------------------------------------
+
+namespace shared
+{
+template<class Signature>
+class FunctionRef;
+
+//--------------------------------------------------------------------------------------------------
+
+// Non-owning reference to a callable, for the callbacks on the hot path. Unlike `std::function`, it never allocates
+// and is just as cheap to pass around as a pointer.
+//
+// Only lvalues can be referenced, since the callable has to outlive the reference (e.g. the coroutine that holds it).
+template<class Result, class... Args>
+class FunctionRef<Result(Args...)> final
+{
+public:
+    template<class Callable>
+        requires(!std::is_same_v<std::remove_cv_t<Callable>, FunctionRef>
+                 && std::is_invocable_r_v<Result, Callable&, Args...>)
+    FunctionRef(Callable& callable)
+        : m_callable{const_cast<void*>(static_cast<const void*>(std::addressof(callable)))}
+        , m_invoke{[](void* callable, Args... args) -> Result
+                   { return (*static_cast<Callable*>(callable))(std::forward<Args>(args)...); }}
+    {
+    }
+
+    Result operator()(Args... args) const
+    {
+        return m_invoke(m_callable, std::forward<Args>(args)...);
+    }
+
+private:
+    void* m_callable;
+    Result (*m_invoke)(void*, Args...);
+};
+}  // namespace shared
@@ -152,4 +152,23 @@ struct GamepadData
 //--------------------------------------------------------------------------------------------------
 
 using GamepadDataContainer = std::array<std::optional<GamepadData>, 4>;
+
+//--------------------------------------------------------------------------------------------------
+
+// Digital changes (buttons) are latency critical, while the analog ones (sticks, touchpad and motion) can be merged
+// into the next broadcast tick
+enum class UpdatePriority
+{
+    Coalesced,
+    Immediate
+};
+
+//--------------------------------------------------------------------------------------------------
+
+// Incremented (per pad) whenever the port info of a gamepad changes, i.e. it is (dis)connected or its battery or gyro
+// state changes. Allows caching everything that is built only from the port info of the pad.
+struct PortInfoGenerations
+{
+    std::array<std::uint64_t, 4> m_values{};
+};
 }  // namespace shared
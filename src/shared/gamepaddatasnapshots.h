@@ -0,0 +1,116 @@
+#pragma once
+
+// system includes
+#include <algorithm>
+#include <atomic>
+#include <boost/assert.hpp>
+#include <boost/move/core.hpp>
+
+// local includes
+#include "gamepaddata.h"
+#include "seqlock.h"
+
+//--------------------------------------------------------------------------------------------------
+
+namespace shared
+{
+struct GamepadDataSnapshot
+{
+    std::uint64_t              m_sequence{0};  // Increases with every publish of the pad
+    std::optional<GamepadData> m_data;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+// The gamepad data as published by the input thread for the network thread. Each pad is a separate snapshot that is
+// read lock-free. The port info generation of a pad is published after its data, so that once the readers see the new
+// generation, they also see (at least) the pad data that it belongs to. It is kept per pad, as the port info of the
+// other pads of the same input batch might not have been published yet.
+//
+// A reader that falls behind only sees the latest snapshot of a pad, except for the immediate updates (e.g. a button
+// press), which are also held in a small ring per pad. So a quick tap that is overwritten before the reader gets to it
+// is still delivered (see `forEachHeldSnapshot`).
+class GamepadDataSnapshots final
+{
+    BOOST_MOVABLE_BUT_NOT_COPYABLE(GamepadDataSnapshots)
+
+public:
+    // Enough for every update of a pad within a whole batch of the input loop, which publishes it without pausing
+    static constexpr std::size_t HELD_CAPACITY{64};
+
+    explicit GamepadDataSnapshots() = default;
+
+    // Note: must only be called from the input thread
+    void publish(std::uint8_t index, const std::optional<GamepadData>& data,
+                 const PortInfoGenerations& port_info_generations, UpdatePriority priority)
+    {
+        BOOST_ASSERT(index < m_pads.size());
+        auto& pad{m_pads[index]};
+
+        const GamepadDataSnapshot snapshot{++pad.m_sequence, data};
+        if (priority == UpdatePriority::Immediate)
+        {
+            const auto held_count{pad.m_held_count.load(std::memory_order_relaxed)};
+            pad.m_held[held_count % HELD_CAPACITY].write(snapshot);
+            pad.m_held_count.store(held_count + 1, std::memory_order_release);
+        }
+
+        pad.m_latest.write(snapshot);
+        pad.m_port_info_generation.store(port_info_generations.m_values[index], std::memory_order_release);
+    }
+
+    std::optional<GamepadData> read(std::uint8_t index) const
+    {
+        return readSnapshot(index).m_data;
+    }
+
+    GamepadDataSnapshot readSnapshot(std::uint8_t index) const
+    {
+        BOOST_ASSERT(index < m_pads.size());
+        return m_pads[index].m_latest.read();
+    }
+
+    // Calls `callback(const GamepadDataSnapshot&)` for the held snapshots of the pad that are newer than `sequence`,
+    // oldest first. The ones that have been overwritten in the ring in the meantime are skipped.
+    template<class Callback>
+    void forEachHeldSnapshot(std::uint8_t index, std::uint64_t sequence, Callback&& callback) const
+    {
+        BOOST_ASSERT(index < m_pads.size());
+        const auto& pad{m_pads[index]};
+
+        const auto held_count{pad.m_held_count.load(std::memory_order_acquire)};
+        for (auto i = held_count - std::min<std::uint64_t>(held_count, HELD_CAPACITY); i < held_count; ++i)
+        {
+            const auto snapshot{pad.m_held[i % HELD_CAPACITY].read()};
+            if (snapshot.m_sequence > sequence)
+            {
+                sequence = snapshot.m_sequence;
+                callback(snapshot);
+            }
+        }
+    }
+
+    std::size_t size() const
+    {
+        return m_pads.size();
+    }
+
+    std::uint64_t getPortInfoGeneration(std::uint8_t index) const
+    {
+        BOOST_ASSERT(index < m_pads.size());
+        return m_pads[index].m_port_info_generation.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Pad
+    {
+        SeqLock<GamepadDataSnapshot>                            m_latest;
+        std::array<SeqLock<GamepadDataSnapshot>, HELD_CAPACITY> m_held;
+        std::atomic<std::uint64_t>                              m_held_count{0};
+        std::atomic<std::uint64_t>                              m_port_info_generation{0};
+        std::uint64_t                                           m_sequence{0};  // Only used by the input thread
+    };
+
+    std::array<Pad, 4> m_pads;
+};
+}  // namespace shared
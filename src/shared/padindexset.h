@@ -0,0 +1,79 @@
+#pragma once
+
+// system includes
+#include <bit>
+#include <boost/assert.hpp>
+#include <cstdint>
+
+// local includes
+
+//--------------------------------------------------------------------------------------------------
+
+namespace shared
+{
+// Set of the pad indexes (0-3) stored as a bitmask. Just like std::set, the indexes are iterated in ascending order.
+class PadIndexSet final
+{
+public:
+    class Iterator final
+    {
+    public:
+        explicit Iterator(std::uint8_t mask)
+            : m_mask{mask}
+        {
+        }
+
+        std::uint8_t operator*() const
+        {
+            return static_cast<std::uint8_t>(std::countr_zero(m_mask));
+        }
+
+        Iterator& operator++()
+        {
+            // Clears the lowest set bit
+            m_mask &= static_cast<std::uint8_t>(m_mask - 1);
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const = default;
+
+    private:
+        std::uint8_t m_mask;
+    };
+
+    void insert(std::uint8_t index)
+    {
+        BOOST_ASSERT(index < 4);
+        m_mask |= static_cast<std::uint8_t>(1u << index);
+    }
+
+    void erase(std::uint8_t index)
+    {
+        BOOST_ASSERT(index < 4);
+        m_mask &= static_cast<std::uint8_t>(~(1u << index));
+    }
+
+    void clear()
+    {
+        m_mask = 0;
+    }
+
+    bool empty() const
+    {
+        return m_mask == 0;
+    }
+
+    Iterator begin() const
+    {
+        return Iterator{m_mask};
+    }
+
+    Iterator end() const
+    {
+        return Iterator{0};
+    }
+
+private:
+    std::uint8_t m_mask{0};
+};
+}  // namespace shared
@@ -0,0 +1,207 @@
+// class header include
+#include "realtime.h"
+
+// system includes
+#include <boost/log/trivial.hpp>
+#include <boost/system/error_code.hpp>
+#include <cerrno>
+#include <cstdlib>
+
+#if defined(__linux__)
+    #include <array>
+    #include <linux/capability.h>
+    #include <pthread.h>
+    #include <sched.h>
+    #include <sys/mman.h>
+    #include <sys/resource.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+#if defined(__GLIBC__)
+    #include <malloc.h>
+#endif
+
+// local includes
+
+//--------------------------------------------------------------------------------------------------
+
+namespace
+{
+#if defined(__linux__)
+bool hasEffectiveCapability(int capability)
+{
+    __user_cap_header_struct                                     header{_LINUX_CAPABILITY_VERSION_3, 0};
+    std::array<__user_cap_data_struct, _LINUX_CAPABILITY_U32S_3> data{};
+    if (::syscall(SYS_capget, &header, data.data()) != 0)
+    {
+        return false;
+    }
+
+    return (data[capability / 32].effective & (1u << (capability % 32))) != 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Locking the future mappings as well is only safe without a memlock limit. With a limit, every mapping that does not
+// fit under it fails instead, e.g. the stack of a thread started later on, which would take the whole server down.
+bool canLockFutureMemory()
+{
+    rlimit limit{};
+    if (::getrlimit(RLIMIT_MEMLOCK, &limit) != 0)
+    {
+        return false;
+    }
+
+    return limit.rlim_cur == RLIM_INFINITY || hasEffectiveCapability(CAP_IPC_LOCK);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void lockMemory()
+{
+    int flags{MCL_CURRENT};
+    if (canLockFutureMemory())
+    {
+        // Also locks the memory mapped later on, e.g. the stacks of the threads and the pre-faulted heap
+        flags |= MCL_FUTURE;
+    }
+    else
+    {
+        BOOST_LOG_TRIVIAL(warning) << "The memlock limit only allows locking the memory mapped so far (requires "
+                                      "CAP_IPC_LOCK or an unlimited memlock limit to lock the memory of the threads).";
+    }
+
+    if (::mlockall(flags) != 0)
+    {
+        const boost::system::error_code error{errno, boost::system::system_category()};
+        BOOST_LOG_TRIVIAL(warning) << "Failed to lock the memory (requires CAP_IPC_LOCK or a large enough "
+                                      "memlock limit): ["
+                                   << error << "] " << error.message();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+int getCpu(const shared::RealtimeSettings& settings, std::size_t thread_index)
+{
+    const auto& cpus{settings.m_cpus};
+    if (cpus.size() <= 1)
+    {
+        // Shared by all the threads
+        return cpus.empty() ? -1 : cpus.front();
+    }
+
+    return thread_index < cpus.size() ? cpus[thread_index] : -1;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void prefaultHeap(std::size_t size)
+{
+    #if defined(__GLIBC__)
+    // The freed memory has to stay in the heap (instead of being returned to the OS), otherwise it would have to be
+    // faulted in again
+    if (mallopt(M_MMAP_MAX, 0) == 0 || mallopt(M_TRIM_THRESHOLD, -1) == 0)
+    {
+        BOOST_LOG_TRIVIAL(warning) << "Failed to keep the freed memory in the heap, skipping the heap pre-faulting.";
+        return;
+    }
+
+    // Only the main arena is pre-faulted here, while glibc would give the threads started later on arenas of their own.
+    // Limiting it to the main arena keeps every thread on the pre-faulted memory. The resulting lock contention does
+    // not matter, as the hot path does not allocate.
+    if (mallopt(M_ARENA_MAX, 1) == 0)
+    {
+        BOOST_LOG_TRIVIAL(warning) << "Failed to limit the heap to the main arena, the threads might still fault in "
+                                      "their own.";
+    }
+
+    auto* const memory{static_cast<volatile char*>(std::malloc(size))};
+    if (memory == nullptr)
+    {
+        BOOST_LOG_TRIVIAL(warning) << "Failed to allocate " << size << " bytes for pre-faulting the heap.";
+        return;
+    }
+
+    const auto page_size{static_cast<std::size_t>(::sysconf(_SC_PAGESIZE))};
+    for (std::size_t offset = 0; offset < size; offset += page_size)
+    {
+        memory[offset] = 0;
+    }
+
+    std::free(const_cast<char*>(memory));
+    BOOST_LOG_TRIVIAL(debug) << "Pre-faulted " << size << " bytes of heap.";
+    #else
+    BOOST_LOG_TRIVIAL(warning) << "Pre-faulting the heap is only supported with glibc, skipping it (" << size
+                               << " bytes).";
+    #endif
+}
+#endif
+}  // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+namespace shared
+{
+void prepareRealtimeMemory([[maybe_unused]] const RealtimeSettings& settings)
+{
+#if defined(__linux__)
+    if (settings.m_lock_memory)
+    {
+        lockMemory();
+    }
+
+    if (settings.m_prefault_heap_size > 0)
+    {
+        prefaultHeap(settings.m_prefault_heap_size);
+    }
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void applyRealtimeScheduling([[maybe_unused]] const RealtimeSettings& settings,
+                             [[maybe_unused]] std::size_t             thread_index,
+                             [[maybe_unused]] std::string_view        thread_name)
+{
+#if defined(__linux__)
+    const int cpu{getCpu(settings, thread_index)};
+    if (cpu >= CPU_SETSIZE)
+    {
+        BOOST_LOG_TRIVIAL(warning) << "CPU " << cpu << " is out of range, the " << thread_name
+                                   << " thread is not pinned.";
+    }
+    else if (cpu >= 0)
+    {
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(cpu, &cpu_set);
+
+        const int result{::pthread_setaffinity_np(::pthread_self(), sizeof(cpu_set), &cpu_set)};
+        if (result != 0)
+        {
+            const boost::system::error_code error{result, boost::system::system_category()};
+            BOOST_LOG_TRIVIAL(warning) << "Failed to pin the " << thread_name << " thread to CPU " << cpu << ": ["
+                                       << error << "] " << error.message();
+        }
+    }
+
+    if (settings.m_priority > 0)
+    {
+        const int   policy{settings.m_policy == RealtimeSettings::Policy::Fifo ? SCHED_FIFO : SCHED_RR};
+        sched_param parameters{};
+        parameters.sched_priority = settings.m_priority;
+
+        const int result{::pthread_setschedparam(::pthread_self(), policy, &parameters)};
+        if (result != 0)
+        {
+            const boost::system::error_code error{result, boost::system::system_category()};
+            BOOST_LOG_TRIVIAL(warning) << "Failed to change the scheduling of the " << thread_name
+                                       << " thread (requires CAP_SYS_NICE or a large enough rtprio limit): [" << error
+                                       << "] " << error.message();
+        }
+    }
+#endif
+}
+}  // namespace shared
@@ -0,0 +1,24 @@
+#pragma once
+
+// system includes
+#include <cstddef>
+#include <string_view>
+
+// local includes
+#include "realtimesettings.h"
+
+//--------------------------------------------------------------------------------------------------
+
+namespace shared
+{
+// Locks the memory of the process and pre-faults the heap, so that the hot path does not page fault. Must be called
+// before the threads are started, as pre-faulting also makes all of them share the (pre-faulted) main heap arena. The
+// memory mapped later on (e.g. the stacks of the threads) is only locked as well with CAP_IPC_LOCK or without a memlock
+// limit. Every step that is not permitted (or supported) is skipped with a warning.
+void prepareRealtimeMemory(const RealtimeSettings& settings);
+
+// Applies the scheduling policy and the CPU affinity to the calling thread. A single CPU is shared by all the threads,
+// otherwise each thread gets its own one by its index (the input thread first, then each of the server workers). Every
+// step that is not permitted (or supported) is skipped with a warning.
+void applyRealtimeScheduling(const RealtimeSettings& settings, std::size_t thread_index, std::string_view thread_name);
+}  // namespace shared
@@ -0,0 +1,28 @@
+#pragma once
+
+// system includes
+#include <cstddef>
+#include <vector>
+
+// local includes
+
+//--------------------------------------------------------------------------------------------------
+
+namespace shared
+{
+struct RealtimeSettings
+{
+    enum class Policy
+    {
+        Fifo,
+        RoundRobin
+    };
+
+    Policy           m_policy{Policy::Fifo};
+    int              m_priority{0};            // Zero keeps the default scheduling
+    std::vector<int> m_cpus;                   // Empty keeps the default affinity (see `applyRealtimeScheduling`)
+    bool             m_lock_memory{false};
+    std::size_t      m_prefault_heap_size{0};  // In bytes
+    bool             m_busy_spin{false};
+};
+}  // namespace shared
@@ -0,0 +1,86 @@
+#pragma once
+
+// system includes
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// local includes
+
+//--------------------------------------------------------------------------------------------------
+
+namespace shared
+{
+// Publishes a value from a single writer thread to any number of reader threads without locking. The readers retry
+// until they have copied the value without the writer touching it in the meantime, so the writer is never blocked.
+//
+// The value is stored as atomic words (instead of a plain copy guarded by fences), so that the racing reads are well
+// defined.
+template<class T>
+class SeqLock final
+{
+    static_assert(std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>);
+
+public:
+    explicit SeqLock()
+    {
+        write(T{});
+    }
+
+    // Note: must only be called from a single thread
+    void write(const T& value)
+    {
+        std::array<std::uint64_t, WORD_COUNT> words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+
+        // An odd sequence marks the write in progress
+        const auto sequence{m_sequence.load(std::memory_order_relaxed)};
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (std::size_t i = 0; i < WORD_COUNT; ++i)
+        {
+            m_words[i].store(words[i], std::memory_order_relaxed);
+        }
+
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    T read() const
+    {
+        std::array<std::uint64_t, WORD_COUNT> words;
+        for (;;)
+        {
+            const auto sequence{m_sequence.load(std::memory_order_acquire)};
+            if ((sequence & 1) != 0)
+            {
+                continue;
+            }
+
+            for (std::size_t i = 0; i < WORD_COUNT; ++i)
+            {
+                words[i] = m_words[i].load(std::memory_order_relaxed);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_sequence.load(std::memory_order_relaxed) == sequence)
+            {
+                break;
+            }
+        }
+
+        T value;
+        // Note: fine for any trivially copyable type, the cast only silences the warning about the non-trivial ctor
+        std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+        return value;
+    }
+
+private:
+    static constexpr std::size_t WORD_COUNT{(sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t)};
+
+    std::atomic<std::uint64_t>                         m_sequence{0};
+    std::array<std::atomic<std::uint64_t>, WORD_COUNT> m_words{};
+};
+}  // namespace shared
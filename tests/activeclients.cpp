@@ -0,0 +1,416 @@
+// system includes
+#include <bit>
+#include <boost/log/core.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/trivial.hpp>
+#include <chrono>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+// local includes
+#include "check.h"
+#include "server/activeclients.h"
+
+//--------------------------------------------------------------------------------------------------
+
+// Checks the client table of ActiveClients through its public interface: a client that is already in the table must
+// be found (refreshing it does not change the number of clients), while the removal of a client must keep all the
+// others reachable. The hash of the clients is public, so the probe sequences of the table can be set up on purpose.
+// Once the table (or the quota of an address) is full, the least recently active client must make room for a new
+// one, and the subscriptions must expire after the timeout (counted from the last request) even if the expiry is
+// running late.
+
+//--------------------------------------------------------------------------------------------------
+
+namespace
+{
+using namespace std::chrono_literals;
+
+//--------------------------------------------------------------------------------------------------
+
+struct TestClient
+{
+    boost::asio::ip::udp::endpoint m_endpoint;
+    std::uint32_t                  m_client_id;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+shared::PadIndexSet makePadIndexSet(std::uint8_t index)
+{
+    shared::PadIndexSet indexes;
+    indexes.insert(index);
+    return indexes;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Hands out clients (each with an endpoint of its own) whose hash maps to the requested slot of the table
+class ClientFactory final
+{
+public:
+    explicit ClientFactory(std::size_t max_clients)
+        : m_mask{std::bit_ceil(max_clients * 2) - 1}
+    {
+    }
+
+    TestClient makeClient(std::size_t ideal_slot)
+    {
+        while (true)
+        {
+            const TestClient client{{boost::asio::ip::address_v4::loopback(), m_next_port++}, 1};
+            if ((server::hashValue({client.m_client_id, client.m_endpoint}) & m_mask) == ideal_slot)
+            {
+                return client;
+            }
+        }
+    }
+
+private:
+    std::size_t   m_mask;
+    std::uint16_t m_next_port{1024};
+};
+
+//--------------------------------------------------------------------------------------------------
+
+void addClient(server::ActiveClients& clients, const TestClient& client)
+{
+    clients.updateRequestTime(client.m_endpoint, client.m_client_id, makePadIndexSet(0));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool isFound(server::ActiveClients& clients, const TestClient& client)
+{
+    const auto number_of_clients{clients.getNumberOfClients()};
+    addClient(clients, client);
+    return clients.getNumberOfClients() == number_of_clients;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::size_t countSubscriptions(server::ActiveClients& clients, const boost::asio::ip::udp::endpoint& endpoint)
+{
+    std::size_t count{0};
+    clients.forEachRelevantEndpoint(0, std::chrono::steady_clock::now(),
+                                    [&](const boost::asio::ip::udp::endpoint& subscriber, std::uint32_t)
+                                    { count += subscriber == endpoint ? 1 : 0; });
+    return count;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+boost::asio::ip::udp::endpoint makeEndpoint(std::uint32_t address, std::uint16_t port)
+{
+    return {boost::asio::ip::address_v4{address}, port};
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// The request times are taken from the clock by ActiveClients, so the requests have to be apart to have an order
+void addClientAfterPause(server::ActiveClients& clients, const boost::asio::ip::udp::endpoint& endpoint)
+{
+    std::this_thread::sleep_for(2ms);
+    clients.updateRequestTime(endpoint, 1, makePadIndexSet(0));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool isSubscribed(server::ActiveClients& clients, const boost::asio::ip::udp::endpoint& endpoint)
+{
+    return countSubscriptions(clients, endpoint) == 1;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void checkInsertAndFind()
+{
+    server::ClientSettings settings;
+    settings.m_max_clients             = 8;
+    settings.m_max_clients_per_address = 8;
+
+    server::ActiveClients clients{settings};
+    ClientFactory         factory{settings.m_max_clients};
+    const auto            client{factory.makeClient(3)};
+
+    addClient(clients, client);
+    TEST_CHECK(clients.getNumberOfClients() == 1);
+    TEST_CHECK(isFound(clients, client));
+    TEST_CHECK(countSubscriptions(clients, client.m_endpoint) == 1);
+
+    // Subscribing to another pad does not add another client
+    clients.updateRequestTime(client.m_endpoint, client.m_client_id, makePadIndexSet(2));
+    TEST_CHECK(clients.getNumberOfClients() == 1);
+
+    // The client id is part of the key
+    clients.updateRequestTime(client.m_endpoint, client.m_client_id + 1, makePadIndexSet(0));
+    TEST_CHECK(clients.getNumberOfClients() == 2);
+    TEST_CHECK(countSubscriptions(clients, client.m_endpoint) == 2);
+
+    // Both of them are removed together with the endpoint
+    clients.removeEndpoint(client.m_endpoint);
+    TEST_CHECK(clients.getNumberOfClients() == 0);
+    TEST_CHECK(countSubscriptions(clients, client.m_endpoint) == 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Inserts the clients with the given ideal slots (in order), removes each of them in turn from a fresh table and
+// checks that the rest is still found
+void checkErase(const std::vector<std::size_t>& ideal_slots)
+{
+    server::ClientSettings settings;
+    settings.m_max_clients             = 8;  // 16 slots
+    settings.m_max_clients_per_address = 8;
+
+    ClientFactory           factory{settings.m_max_clients};
+    std::vector<TestClient> test_clients;
+    for (const auto ideal_slot : ideal_slots)
+    {
+        test_clients.push_back(factory.makeClient(ideal_slot));
+    }
+
+    for (std::size_t erased = 0; erased < test_clients.size(); ++erased)
+    {
+        server::ActiveClients clients{settings};
+        for (const auto& client : test_clients)
+        {
+            addClient(clients, client);
+        }
+
+        clients.removeEndpoint(test_clients[erased].m_endpoint);
+        TEST_CHECK(clients.getNumberOfClients() == test_clients.size() - 1);
+
+        for (std::size_t i = 0; i < test_clients.size(); ++i)
+        {
+            if (i != erased)
+            {
+                TEST_CHECK(isFound(clients, test_clients[i]));
+                TEST_CHECK(countSubscriptions(clients, test_clients[i].m_endpoint) == 1);
+            }
+        }
+
+        // The freed slot is reused
+        addClient(clients, test_clients[erased]);
+        TEST_CHECK(clients.getNumberOfClients() == test_clients.size());
+        for (const auto& client : test_clients)
+        {
+            TEST_CHECK(isFound(clients, client));
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void checkBackwardShiftDeletion()
+{
+    // A single cluster, everything after the freed slot moves back
+    checkErase({5, 5, 5});
+    // An entry that already sits in its ideal slot must not move, but the one behind it has to
+    checkErase({5, 6, 5});
+    checkErase({5, 6, 6, 5, 8});
+    // Two clusters that have grown into each other
+    checkErase({4, 4, 6, 6, 4});
+    // Clusters that wrap around the end of the table
+    checkErase({15, 15, 0, 15, 1});
+    checkErase({14, 15, 14, 0, 0, 2});
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void checkRandomOperations()
+{
+    server::ClientSettings settings;
+    settings.m_max_clients             = 64;
+    settings.m_max_clients_per_address = 64;
+
+    // At most as many clients as the table holds, so none of them are evicted
+    std::mt19937            random{1234};
+    ClientFactory           factory{settings.m_max_clients};
+    std::vector<TestClient> test_clients;
+    for (std::size_t i = 0; i < settings.m_max_clients; ++i)
+    {
+        // Few ideal slots, so that the clusters are long
+        test_clients.push_back(factory.makeClient(random() % 16));
+    }
+
+    server::ActiveClients clients{settings};
+    std::set<std::size_t> expected_clients;
+    std::size_t           failures{0};
+    for (int operation = 0; operation < 5000; ++operation)
+    {
+        const std::size_t i{random() % test_clients.size()};
+        if (expected_clients.contains(i))
+        {
+            clients.removeEndpoint(test_clients[i].m_endpoint);
+            expected_clients.erase(i);
+        }
+        else
+        {
+            addClient(clients, test_clients[i]);
+            expected_clients.insert(i);
+        }
+
+        failures += clients.getNumberOfClients() != expected_clients.size() ? 1 : 0;
+        for (const auto expected : expected_clients)
+        {
+            failures += isFound(clients, test_clients[expected]) ? 0 : 1;
+        }
+    }
+    TEST_CHECK(failures == 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void checkLeastRecentlyActiveEviction()
+{
+    server::ClientSettings settings;
+    settings.m_max_clients             = 4;
+    settings.m_max_clients_per_address = 4;
+
+    server::ActiveClients                       clients{settings};
+    std::vector<boost::asio::ip::udp::endpoint> endpoints;
+    for (std::uint16_t port = 1000; port < 1006; ++port)
+    {
+        endpoints.push_back(makeEndpoint(0x7F000001, port));
+    }
+
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+        addClientAfterPause(clients, endpoints[i]);
+    }
+
+    // The first client is refreshed, so the second one is the least recently active now
+    addClientAfterPause(clients, endpoints[0]);
+    TEST_CHECK(clients.getNumberOfClients() == 4);
+
+    addClientAfterPause(clients, endpoints[4]);
+    TEST_CHECK(clients.getNumberOfClients() == 4);
+    TEST_CHECK(!isSubscribed(clients, endpoints[1]));
+    TEST_CHECK(isSubscribed(clients, endpoints[0]));
+    TEST_CHECK(isSubscribed(clients, endpoints[2]));
+    TEST_CHECK(isSubscribed(clients, endpoints[3]));
+    TEST_CHECK(isSubscribed(clients, endpoints[4]));
+
+    addClientAfterPause(clients, endpoints[5]);
+    TEST_CHECK(clients.getNumberOfClients() == 4);
+    TEST_CHECK(!isSubscribed(clients, endpoints[2]));
+    TEST_CHECK(isSubscribed(clients, endpoints[0]));
+    TEST_CHECK(isSubscribed(clients, endpoints[5]));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void checkPerAddressEviction()
+{
+    server::ClientSettings settings;
+    settings.m_max_clients             = 8;
+    settings.m_max_clients_per_address = 2;
+
+    server::ActiveClients clients{settings};
+    const auto            other_client{makeEndpoint(0x0A000002, 1000)};
+    const auto            first_client{makeEndpoint(0x0A000001, 1000)};
+    const auto            second_client{makeEndpoint(0x0A000001, 1001)};
+    const auto            third_client{makeEndpoint(0x0A000001, 1002)};
+
+    addClientAfterPause(clients, other_client);
+    addClientAfterPause(clients, first_client);
+    addClientAfterPause(clients, second_client);
+    TEST_CHECK(clients.getNumberOfClients() == 3);
+
+    // The oldest client of the same address makes room, even though the table is not full and the client of the other
+    // address is older
+    addClientAfterPause(clients, third_client);
+    TEST_CHECK(clients.getNumberOfClients() == 3);
+    TEST_CHECK(!isSubscribed(clients, first_client));
+    TEST_CHECK(isSubscribed(clients, second_client));
+    TEST_CHECK(isSubscribed(clients, third_client));
+    TEST_CHECK(isSubscribed(clients, other_client));
+
+    // The other address still has room
+    addClientAfterPause(clients, makeEndpoint(0x0A000002, 1001));
+    TEST_CHECK(clients.getNumberOfClients() == 4);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void checkExpiry()
+{
+    server::ClientSettings settings;
+    settings.m_timeout = 320ms;
+
+    server::ActiveClients clients{settings};
+    const auto            tick{clients.getExpiryInterval()};
+    const auto            endpoint{makeEndpoint(0x7F000001, 1000)};
+
+    const auto before_request{std::chrono::steady_clock::now()};
+    clients.updateRequestTime(endpoint, 1, makePadIndexSet(0));
+    const auto after_request{std::chrono::steady_clock::now()};
+
+    // Not a moment too soon
+    clients.expireClients(before_request + settings.m_timeout - tick);
+    TEST_CHECK(isSubscribed(clients, endpoint));
+
+    // A refresh pushes the deadline out, which is noticed once the entry of the client comes up in the wheel
+    std::this_thread::sleep_for(5 * tick);
+    const auto before_refresh{std::chrono::steady_clock::now()};
+    clients.updateRequestTime(endpoint, 1, makePadIndexSet(0));
+    const auto after_refresh{std::chrono::steady_clock::now()};
+
+    clients.expireClients(after_request + settings.m_timeout + tick);
+    TEST_CHECK(isSubscribed(clients, endpoint));
+    clients.expireClients(before_refresh + settings.m_timeout - tick);
+    TEST_CHECK(isSubscribed(clients, endpoint));
+
+    clients.expireClients(after_refresh + settings.m_timeout + tick);
+    TEST_CHECK(!isSubscribed(clients, endpoint));
+    TEST_CHECK(clients.getNumberOfClients() == 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void checkLateExpiry()
+{
+    server::ClientSettings settings;
+    settings.m_timeout = 320ms;
+
+    server::ActiveClients                       clients{settings};
+    const auto                                  tick{clients.getExpiryInterval()};
+    std::vector<boost::asio::ip::udp::endpoint> endpoints;
+    for (std::uint16_t port = 1000; port < 1004; ++port)
+    {
+        // Spread over multiple slots of the wheel
+        endpoints.push_back(makeEndpoint(0x7F000001, port));
+        clients.updateRequestTime(endpoints.back(), 1, makePadIndexSet(0));
+        std::this_thread::sleep_for(3 * tick);
+    }
+
+    // The expiry has not run for a lot more than a full turn of the wheel, so it catches up by going through each of
+    // the slots once
+    clients.expireClients(std::chrono::steady_clock::now() + 10 * settings.m_timeout);
+    TEST_CHECK(clients.getNumberOfClients() == 0);
+    for (const auto& endpoint : endpoints)
+    {
+        TEST_CHECK(!isSubscribed(clients, endpoint));
+    }
+}
+}  // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+int main()
+{
+    boost::log::core::get()->set_filter(boost::log::trivial::severity >= boost::log::trivial::warning);
+
+    checkInsertAndFind();
+    checkBackwardShiftDeletion();
+    checkRandomOperations();
+    checkLeastRecentlyActiveEviction();
+    checkPerAddressEviction();
+    checkExpiry();
+    checkLateExpiry();
+
+    return tests::getExitCode();
+}
@@ -0,0 +1,64 @@
+// system includes
+#include <boost/log/core.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/trivial.hpp>
+#include <iomanip>
+#include <iostream>
+
+// local includes
+#include "microbenchmark.h"
+#include "server/activeclients.h"
+
+//--------------------------------------------------------------------------------------------------
+
+// Measures the cost of a pad update fan-out in ActiveClients (going through the subscribers of the pad, without
+// sending anything) against the number of clients. Each client subscribes to all 4 pads, so the largest run holds
+// 16384 subscriptions.
+
+//--------------------------------------------------------------------------------------------------
+
+namespace
+{
+constexpr std::size_t TOTAL_SUBSCRIBERS{10000000};  // Per measured run, spread over the fan-outs
+}  // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+int main()
+{
+    boost::log::core::get()->set_filter(boost::log::trivial::severity >= boost::log::trivial::warning);
+
+    for (const std::size_t number_of_clients : {16, 64, 256, 1024, 4096})
+    {
+        server::ClientSettings settings;
+        settings.m_max_clients             = number_of_clients;
+        settings.m_max_clients_per_address = number_of_clients;
+
+        server::ActiveClients clients{settings};
+        for (std::size_t i = 0; i < number_of_clients; ++i)
+        {
+            const auto address{boost::asio::ip::address_v4{static_cast<std::uint32_t>(0x0A000000 + i / 256)}};
+            const auto port{static_cast<std::uint16_t>(1024 + i % 256)};
+            clients.updateRequestTime({address, port}, static_cast<std::uint32_t>(i), shared::PadIndexSet{});
+        }
+
+        const auto now{std::chrono::steady_clock::now()};
+        const auto duration{tests::measureCall(
+            TOTAL_SUBSCRIBERS / number_of_clients,
+            [&](std::size_t call)
+            {
+                std::uint64_t sum{0};
+                clients.forEachRelevantEndpoint(static_cast<std::uint8_t>(call % 4), now,
+                                                [&sum](const boost::asio::ip::udp::endpoint& endpoint,
+                                                       std::uint32_t                         packet_counter)
+                                                { sum += endpoint.port() + packet_counter; });
+                tests::keepResult(sum);
+            })};
+
+        std::cout << std::fixed << std::setprecision(2) << "Clients: " << std::setw(5) << number_of_clients
+                  << ", per fan-out: " << std::setw(10) << duration.count() << " ns, per subscriber: " << std::setw(6)
+                  << duration.count() / static_cast<double>(number_of_clients) << " ns" << std::endl;
+    }
+
+    return 0;
+}
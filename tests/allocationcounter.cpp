@@ -0,0 +1,134 @@
+// class header include
+#include "allocationcounter.h"
+
+// system includes
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// local includes
+
+//--------------------------------------------------------------------------------------------------
+
+namespace
+{
+std::atomic<std::size_t> g_allocations{0};
+
+//--------------------------------------------------------------------------------------------------
+
+void* allocate(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* const pointer{std::malloc(size > 0 ? size : 1)})
+    {
+        return pointer;
+    }
+    throw std::bad_alloc{};
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void* allocateAligned(std::size_t size, std::align_val_t alignment)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    const auto alignment_value{static_cast<std::size_t>(alignment)};
+#if defined(_WIN32)
+    void* const pointer{_aligned_malloc(size > 0 ? size : 1, alignment_value)};
+#else
+    // `aligned_alloc` requires the size to be a multiple of the alignment
+    const std::size_t aligned_size{(size + alignment_value) / alignment_value * alignment_value};
+    void* const       pointer{std::aligned_alloc(alignment_value, aligned_size)};
+#endif
+    if (pointer)
+    {
+        return pointer;
+    }
+    throw std::bad_alloc{};
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void deallocateAligned(void* pointer)
+{
+#if defined(_WIN32)
+    _aligned_free(pointer);
+#else
+    std::free(pointer);
+#endif
+}
+}  // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+// Note: kept in their own translation unit, so that they are not inlined into the callers (which compilers can then
+// flag as mismatched)
+void* operator new(std::size_t size)
+{
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return allocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return allocateAligned(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+    deallocateAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept
+{
+    deallocateAligned(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept
+{
+    deallocateAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept
+{
+    deallocateAligned(pointer);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+namespace tests
+{
+std::size_t getAllocationCount()
+{
+    return g_allocations.load();
+}
+}  // namespace tests
@@ -0,0 +1,14 @@
+#pragma once
+
+// system includes
+#include <cstddef>
+
+// local includes
+
+//--------------------------------------------------------------------------------------------------
+
+namespace tests
+{
+// Number of the global `operator new` calls so far (from any thread), which are replaced by the test executable
+std::size_t getAllocationCount();
+}  // namespace tests
@@ -0,0 +1,44 @@
+#pragma once
+
+// system includes
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+
+// local includes
+
+//--------------------------------------------------------------------------------------------------
+
+// Reports a failed check (without stopping the test), `main` returns `tests::getExitCode()` at the end
+#define TEST_CHECK(condition) tests::check((condition), #condition, __FILE__, __LINE__)
+
+//--------------------------------------------------------------------------------------------------
+
+namespace tests
+{
+inline std::size_t g_failed_checks{0};
+
+//--------------------------------------------------------------------------------------------------
+
+inline bool check(bool condition, const char* expression, const char* file, int line)
+{
+    if (!condition)
+    {
+        ++g_failed_checks;
+        std::cout << file << ":" << line << ": check failed: " << expression << std::endl;
+    }
+    return condition;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+inline int getExitCode()
+{
+    if (g_failed_checks > 0)
+    {
+        std::cout << g_failed_checks << " check(s) failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+}  // namespace tests
@@ -0,0 +1,130 @@
+// system includes
+#include <boost/crc.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/trivial.hpp>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <span>
+#include <vector>
+
+// local includes
+#include "check.h"
+#include "server/crc32.h"
+
+//--------------------------------------------------------------------------------------------------
+
+// Checks each of the CRC32 implementations that the CPU supports (not just the one `calculateCrc32` picked) against
+// Boost, for all the sizes around the block sizes of the kernels, unaligned data and checksums calculated in chunks.
+
+//--------------------------------------------------------------------------------------------------
+
+namespace
+{
+constexpr std::size_t MAX_SIZE{1100};   // Multiple rounds of the 64 byte folding plus every possible tail
+constexpr std::size_t MAX_OFFSET{16};  // Every misalignment of a 16 byte load
+
+//--------------------------------------------------------------------------------------------------
+
+std::uint32_t calculateReference(std::span<const std::uint8_t> data)
+{
+    boost::crc_32_type crc;
+    crc.process_bytes(data.data(), data.size());
+    return crc.checksum();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void checkSizesAndOffsets(const server::Crc32Implementation& implementation, std::span<const std::uint8_t> data)
+{
+    std::size_t mismatches{0};
+    for (std::size_t offset = 0; offset < MAX_OFFSET; ++offset)
+    {
+        for (std::size_t size = 0; size <= MAX_SIZE; ++size)
+        {
+            const auto chunk{data.subspan(offset, size)};
+            if (implementation.m_calculate(chunk, 0) != calculateReference(chunk))
+            {
+                ++mismatches;
+            }
+        }
+    }
+    TEST_CHECK(mismatches == 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void checkChunks(const server::Crc32Implementation& implementation, std::span<const std::uint8_t> data,
+                 std::mt19937& random)
+{
+    std::size_t mismatches{0};
+
+    // Every split of a few sizes
+    for (const std::size_t size : {28, 100, 200, 1024})
+    {
+        const auto expected{calculateReference(data.first(size))};
+        for (std::size_t split = 0; split <= size; ++split)
+        {
+            const auto crc{implementation.m_calculate(data.first(split), 0)};
+            if (implementation.m_calculate(data.subspan(split, size - split), crc) != expected)
+            {
+                ++mismatches;
+            }
+        }
+    }
+
+    // Random chunks, starting at random offsets
+    for (int round = 0; round < 1000; ++round)
+    {
+        std::uniform_int_distribution<std::size_t> offset_distribution{0, MAX_OFFSET - 1};
+        std::uniform_int_distribution<std::size_t> size_distribution{0, 300};
+
+        const std::size_t offset{offset_distribution(random)};
+        std::size_t       end{offset};
+        std::uint32_t     crc{0};
+        for (int chunk = 0; chunk < 4; ++chunk)
+        {
+            const std::size_t size{size_distribution(random)};
+            crc = implementation.m_calculate(data.subspan(end, size), crc);
+            end += size;
+        }
+
+        if (crc != calculateReference(data.subspan(offset, end - offset)))
+        {
+            ++mismatches;
+        }
+    }
+
+    TEST_CHECK(mismatches == 0);
+}
+}  // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+int main()
+{
+    boost::log::core::get()->set_filter(boost::log::trivial::severity >= boost::log::trivial::warning);
+
+    std::mt19937                                 random{1234};
+    std::uniform_int_distribution<std::uint32_t> byte_distribution{0, 255};
+
+    std::vector<std::uint8_t> data(MAX_SIZE + MAX_OFFSET);
+    for (auto& byte : data)
+    {
+        byte = static_cast<std::uint8_t>(byte_distribution(random));
+    }
+
+    auto implementations{server::getSupportedCrc32Implementations()};
+    TEST_CHECK(!implementations.empty());
+    implementations.push_back({"selected", &server::calculateCrc32});
+
+    for (const auto& implementation : implementations)
+    {
+        std::cout << "Checking " << implementation.m_name << std::endl;
+        checkSizesAndOffsets(implementation, data);
+        checkChunks(implementation, data, random);
+    }
+
+    return tests::getExitCode();
+}
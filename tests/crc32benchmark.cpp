@@ -0,0 +1,92 @@
+// system includes
+#include <array>
+#include <boost/crc.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/trivial.hpp>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <span>
+#include <string>
+#include <vector>
+
+// local includes
+#include "microbenchmark.h"
+#include "server/crc32.h"
+#include "server/packetlayout.h"
+
+//--------------------------------------------------------------------------------------------------
+
+// Measures the CRC32 implementations (and Boost) on the sizes of the DSU packets, which are too short for the folding
+// of the PCLMULQDQ kernel to kick in.
+
+//--------------------------------------------------------------------------------------------------
+
+namespace
+{
+constexpr std::size_t CALLS{1000000};
+
+//--------------------------------------------------------------------------------------------------
+
+struct Packet
+{
+    const char* m_name;
+    std::size_t m_size;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+void printResult(const std::string& name, std::chrono::duration<double, std::nano> duration, std::size_t size)
+{
+    std::cout << "  " << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(8) << duration.count() << " ns, " << std::setw(6)
+              << static_cast<double>(size) / duration.count() << " bytes/ns" << std::endl;
+}
+}  // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+int main()
+{
+    boost::log::core::get()->set_filter(boost::log::trivial::severity >= boost::log::trivial::warning);
+
+    const std::array packets{
+        Packet{"pad data request", sizeof(server::PadDataRequestLayout)},
+        Packet{"list ports response", sizeof(server::ListPortsResponseLayout)},
+        Packet{"pad data response", sizeof(server::PadDataResponseLayout)},
+    };
+
+    std::array<std::uint8_t, sizeof(server::PadDataResponseLayout)> data;
+    for (std::size_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = static_cast<std::uint8_t>(i * 31 + 7);
+    }
+
+    auto implementations{server::getSupportedCrc32Implementations()};
+    implementations.push_back({"selected", &server::calculateCrc32});
+
+    for (const auto& packet : packets)
+    {
+        const std::span<const std::uint8_t> bytes{data.data(), packet.m_size};
+        std::cout << packet.m_name << " (" << packet.m_size << " bytes):" << std::endl;
+
+        for (const auto& implementation : implementations)
+        {
+            const auto duration{tests::measureCall(
+                CALLS, [&](std::size_t call) { tests::keepResult(implementation.m_calculate(bytes, call)); })};
+            printResult(implementation.m_name, duration, packet.m_size);
+        }
+
+        const auto duration{tests::measureCall(CALLS,
+                                               [&](std::size_t)
+                                               {
+                                                   boost::crc_32_type crc;
+                                                   crc.process_bytes(bytes.data(), bytes.size());
+                                                   tests::keepResult(crc.checksum());
+                                               })};
+        printResult("boost", duration, packet.m_size);
+    }
+
+    return 0;
+}
@@ -0,0 +1,272 @@
+// system includes
+#include <boost/crc.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/trivial.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <variant>
+#include <vector>
+
+// local includes
+#include "check.h"
+#include "server/common.h"
+#include "server/deserialiser.h"
+#include "server/packetlayout.h"
+
+//--------------------------------------------------------------------------------------------------
+
+// Checks that the deserialiser accepts the well-formed requests and rejects the malformed ones (short headers, list
+// ports counts that run past the end of the datagram, pad data requests without the MAC byte and any corruption that
+// the CRC32 catches). The CRC32 of the requests is calculated with Boost over the whole datagram, with the CRC bytes
+// zeroed out, as the reference for the piecewise calculation of the deserialiser.
+
+//--------------------------------------------------------------------------------------------------
+
+namespace
+{
+using server::DsuMsgType;
+
+constexpr std::size_t PACKET_SIZE_OFFSET{offsetof(server::DsuHeader, m_packet_size)};
+constexpr std::size_t CRC_OFFSET{offsetof(server::DsuHeader, m_crc32)};
+constexpr std::size_t MAC_OFFSET{offsetof(server::PadDataRequestLayout, m_mac)};
+
+//--------------------------------------------------------------------------------------------------
+
+void writeUInt32LE(std::vector<std::uint8_t>& data, std::size_t index, std::uint32_t value)
+{
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+        data[index + i] = static_cast<std::uint8_t>(value >> (i * 8));
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Updates the packet size and the CRC32 for the current length of the data (as far as they fit into it)
+void seal(std::vector<std::uint8_t>& data)
+{
+    if (data.size() >= PACKET_SIZE_OFFSET + 2)
+    {
+        const auto packet_size{data.size() - CRC_OFFSET};
+        data[PACKET_SIZE_OFFSET]     = static_cast<std::uint8_t>(packet_size);
+        data[PACKET_SIZE_OFFSET + 1] = static_cast<std::uint8_t>(packet_size >> 8);
+    }
+
+    if (data.size() >= CRC_OFFSET + 4)
+    {
+        writeUInt32LE(data, CRC_OFFSET, 0);
+
+        boost::crc_32_type crc;
+        crc.process_bytes(data.data(), data.size());
+        writeUInt32LE(data, CRC_OFFSET, crc.checksum());
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::vector<std::uint8_t> makeRequest(DsuMsgType msg_type, std::initializer_list<std::uint8_t> payload)
+{
+    std::vector<std::uint8_t> data(sizeof(server::DsuHeader), 0);
+    data[0] = 'D';
+    data[1] = 'S';
+    data[2] = 'U';
+    data[3] = 'C';
+    data[4] = static_cast<std::uint8_t>(server::getProtocolVersion());
+    data[5] = static_cast<std::uint8_t>(server::getProtocolVersion() >> 8);
+    writeUInt32LE(data, offsetof(server::DsuHeader, m_id), 0xC0FFEE);
+    writeUInt32LE(data, offsetof(server::DsuHeader, m_msg_type), server::enumToValue(msg_type));
+    data.insert(data.end(), payload);
+
+    seal(data);
+    return data;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::vector<std::uint8_t> makeListPortsRequest(std::int32_t count, std::initializer_list<std::uint8_t> indexes)
+{
+    auto data{makeRequest(DsuMsgType::ListPorts, {0, 0, 0, 0})};
+    writeUInt32LE(data, offsetof(server::ListPortsRequestLayout, m_request_size), static_cast<std::uint32_t>(count));
+    data.insert(data.end(), indexes);
+
+    seal(data);
+    return data;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::vector<std::uint8_t> makePadDataRequest(std::uint8_t flags, std::uint8_t slot, std::uint8_t mac_index)
+{
+    return makeRequest(DsuMsgType::PadData, {flags, slot, mac_index, 0, 0, 0, 0, 0});
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool isRejected(const std::vector<std::uint8_t>& data)
+{
+    return !server::deserialise(data).has_value();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+template<class Request>
+std::optional<Request> deserialiseAs(const std::vector<std::uint8_t>& data)
+{
+    const auto request{server::deserialise(data)};
+    if (!request || !std::holds_alternative<Request>(*request))
+    {
+        return std::nullopt;
+    }
+    return std::get<Request>(*request);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::vector<std::uint8_t> getIndexes(const shared::PadIndexSet& indexes)
+{
+    std::vector<std::uint8_t> result;
+    for (const auto index : indexes)
+    {
+        result.push_back(index);
+    }
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void checkWellFormedRequests()
+{
+    TEST_CHECK(deserialiseAs<server::VersionRequest>(makeRequest(DsuMsgType::Version, {})).has_value());
+
+    const auto list_ports{deserialiseAs<server::ListPortsRequest>(makeListPortsRequest(2, {3, 0}))};
+    TEST_CHECK(list_ports && getIndexes(list_ports->m_requested_indexes) == std::vector<std::uint8_t>({0, 3}));
+
+    const auto no_ports{deserialiseAs<server::ListPortsRequest>(makeListPortsRequest(0, {}))};
+    TEST_CHECK(no_ports && no_ports->m_requested_indexes.empty());
+
+    const auto slot_based{deserialiseAs<server::PadDataRequest>(makePadDataRequest(0x01, 2, 0))};
+    TEST_CHECK(slot_based && slot_based->m_client_id == 0xC0FFEE);
+    TEST_CHECK(slot_based && getIndexes(slot_based->m_requested_indexes) == std::vector<std::uint8_t>({2}));
+
+    const auto mac_based{deserialiseAs<server::PadDataRequest>(makePadDataRequest(0x02, 0, 1))};
+    TEST_CHECK(mac_based && getIndexes(mac_based->m_requested_indexes) == std::vector<std::uint8_t>({1}));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void checkShortHeader()
+{
+    const auto request{makeRequest(DsuMsgType::Version, {})};
+    for (std::size_t size = 0; size < sizeof(server::DsuHeader); ++size)
+    {
+        std::vector<std::uint8_t> data{request.begin(), request.begin() + static_cast<std::ptrdiff_t>(size)};
+        seal(data);
+        TEST_CHECK(isRejected(data));
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void checkInvalidHeader()
+{
+    auto wrong_magic{makeRequest(DsuMsgType::Version, {})};
+    wrong_magic[3] = 'S';
+    seal(wrong_magic);
+    TEST_CHECK(isRejected(wrong_magic));
+
+    auto wrong_version{makeRequest(DsuMsgType::Version, {})};
+    wrong_version[4] = static_cast<std::uint8_t>(wrong_version[4] + 1);
+    seal(wrong_version);
+    TEST_CHECK(isRejected(wrong_version));
+
+    // The packet size claims more than what was received
+    auto truncated{makeListPortsRequest(2, {0, 1})};
+    truncated.pop_back();
+    TEST_CHECK(isRejected(truncated));
+
+    TEST_CHECK(isRejected(makeRequest(static_cast<DsuMsgType>(0x100003), {})));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void checkListPortsCount()
+{
+    // The count runs past the end of the datagram (with a packet size and CRC32 that match the short datagram)
+    TEST_CHECK(isRejected(makeListPortsRequest(3, {0, 1})));
+    TEST_CHECK(isRejected(makeListPortsRequest(1, {})));
+    TEST_CHECK(isRejected(makeListPortsRequest(4, {0, 1, 2})));
+
+    TEST_CHECK(isRejected(makeListPortsRequest(5, {0, 1, 2, 3, 0})));
+    TEST_CHECK(isRejected(makeListPortsRequest(-1, {0})));
+    TEST_CHECK(isRejected(makeListPortsRequest(1, {4})));
+
+    // Without the count itself
+    TEST_CHECK(isRejected(makeRequest(DsuMsgType::ListPorts, {})));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void checkMissingMac()
+{
+    // Cut right before the first byte of the MAC address, for slot and MAC based registrations
+    for (const std::uint8_t flags : {0x01, 0x02})
+    {
+        auto data{makePadDataRequest(flags, 0, 0)};
+        data.resize(MAC_OFFSET);
+        seal(data);
+        TEST_CHECK(isRejected(data));
+
+        // Only the first byte of the MAC address is used
+        data.push_back(0);
+        seal(data);
+        TEST_CHECK(!isRejected(data));
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void checkCrc()
+{
+    // Any flipped bit is caught (either by the CRC32 or an earlier check)
+    const auto  request{makePadDataRequest(0x01, 2, 0)};
+    std::size_t accepted{0};
+    for (std::size_t index = 0; index < request.size(); ++index)
+    {
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            auto data{request};
+            data[index] ^= static_cast<std::uint8_t>(1 << bit);
+            accepted += isRejected(data) ? 0 : 1;
+        }
+    }
+    TEST_CHECK(accepted == 0);
+
+    // The CRC32 must be the one calculated with the CRC bytes zeroed out, not with whatever they hold
+    auto data{request};
+    writeUInt32LE(data, CRC_OFFSET, 0xFFFFFFFF);
+
+    boost::crc_32_type crc;
+    crc.process_bytes(data.data(), data.size());
+    writeUInt32LE(data, CRC_OFFSET, crc.checksum());
+    TEST_CHECK(isRejected(data));
+}
+}  // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+int main()
+{
+    boost::log::core::get()->set_filter(boost::log::trivial::severity >= boost::log::trivial::warning);
+
+    checkWellFormedRequests();
+    checkShortHeader();
+    checkInvalidHeader();
+    checkListPortsCount();
+    checkMissingMac();
+    checkCrc();
+
+    return tests::getExitCode();
+}
@@ -0,0 +1,109 @@
+// system includes
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
+#include <fcntl.h>
+#include <filesystem>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// local includes
+#include "check.h"
+#include "gamepads/devicewatcher.h"
+#include "shared/coroutines.h"
+
+//--------------------------------------------------------------------------------------------------
+
+// Checks that the input loop can sleep until a pad reports something. A FIFO stands in for the device node of the pad,
+// it is just as readable (and drained) as an evdev or hidraw node.
+
+//--------------------------------------------------------------------------------------------------
+
+namespace
+{
+using namespace std::chrono_literals;
+
+constexpr auto TIMEOUT{100ms};
+constexpr auto TIMEOUT_TOLERANCE{10ms};
+
+//--------------------------------------------------------------------------------------------------
+
+boost::asio::awaitable<std::chrono::steady_clock::duration> measureWait(gamepads::DeviceWatcher& watcher,
+                                                                        std::chrono::milliseconds timeout)
+{
+    const auto start{std::chrono::steady_clock::now()};
+    co_await watcher.wait(timeout);
+    co_return std::chrono::steady_clock::now() - start;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+boost::asio::awaitable<void> runChecks(const std::string& fifo_path, int writer)
+{
+    const auto              executor{co_await boost::asio::this_coro::executor};
+    gamepads::DeviceWatcher watcher{executor};
+
+    // Nothing to wait for until the pads are known
+    TEST_CHECK(!watcher.canWait());
+
+    watcher.watch({fifo_path});
+    TEST_CHECK(watcher.canWait());
+
+    // Without any reports, the wait only ends on the timeout
+    TEST_CHECK(co_await measureWait(watcher, TIMEOUT) >= TIMEOUT - TIMEOUT_TOLERANCE);
+
+    // A report ends the wait right away
+    boost::asio::steady_timer report_timer{executor};
+    report_timer.expires_after(TIMEOUT / 4);
+    report_timer.async_wait([writer](const auto&) { TEST_CHECK(::write(writer, "report", 6) == 6); });
+    TEST_CHECK(co_await measureWait(watcher, 10 * TIMEOUT) < TIMEOUT);
+
+    // The report has been drained, so the next wait sleeps again
+    TEST_CHECK(co_await measureWait(watcher, TIMEOUT) >= TIMEOUT - TIMEOUT_TOLERANCE);
+
+    // A report that arrived before the wait ends it right away as well
+    TEST_CHECK(::write(writer, "report", 6) == 6);
+    TEST_CHECK(co_await measureWait(watcher, 10 * TIMEOUT) < TIMEOUT);
+
+    // A pad without a device node (or one that can not be opened) has to be polled
+    watcher.watch({fifo_path, ""});
+    TEST_CHECK(!watcher.canWait());
+    watcher.watch({fifo_path, fifo_path + "-missing"});
+    TEST_CHECK(!watcher.canWait());
+
+    // Rewatching replaces the earlier devices
+    watcher.watch({fifo_path});
+    TEST_CHECK(watcher.canWait());
+    watcher.watch({});
+    TEST_CHECK(watcher.canWait());
+    TEST_CHECK(::write(writer, "report", 6) == 6);
+    TEST_CHECK(co_await measureWait(watcher, TIMEOUT) >= TIMEOUT - TIMEOUT_TOLERANCE);
+}
+}  // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+int main()
+{
+    const auto fifo_path{(std::filesystem::temp_directory_path()
+                          / ("sdl2dsu-devicewatcher-" + std::to_string(::getpid())))
+                             .string()};
+    if (!TEST_CHECK(::mkfifo(fifo_path.c_str(), 0600) == 0))
+    {
+        return tests::getExitCode();
+    }
+
+    // Opening it for both reading and writing does not block, even though there is no reader yet
+    const int writer{::open(fifo_path.c_str(), O_RDWR | O_NONBLOCK)};
+    if (TEST_CHECK(writer >= 0))
+    {
+        boost::asio::io_context io_context{1};
+        boost::asio::co_spawn(io_context, runChecks(fifo_path, writer), shared::exceptionHandler);
+        io_context.run();
+        ::close(writer);
+    }
+
+    std::filesystem::remove(fifo_path);
+    return tests::getExitCode();
+}
@@ -0,0 +1,35 @@
+// class header include
+#include "dsurequests.h"
+
+// system includes
+#include <cstddef>
+#include <cstring>
+
+// local includes
+#include "server/common.h"
+#include "server/crc32.h"
+
+//--------------------------------------------------------------------------------------------------
+
+namespace tests
+{
+std::array<std::uint8_t, sizeof(server::PadDataRequestLayout)> makePadDataRequest(std::uint8_t index)
+{
+    server::PadDataRequestLayout layout{};
+    layout.m_header.m_magic            = {'D', 'S', 'U', 'C'};
+    layout.m_header.m_protocol_version = server::getProtocolVersion();
+    layout.m_header.m_packet_size      = sizeof(layout) - offsetof(server::DsuHeader, m_crc32);
+    layout.m_header.m_id               = 1;
+    layout.m_header.m_msg_type         = server::enumToValue(server::DsuMsgType::PadData);
+    layout.m_flags                     = 0x01 /* slot based registration */;
+    layout.m_slot                      = index;
+
+    std::array<std::uint8_t, sizeof(layout)> request;
+    std::memcpy(request.data(), &layout, sizeof(layout));
+
+    const auto crc32{server::calculateCrc32(request)};
+    layout.m_header.m_crc32 = crc32;
+    std::memcpy(request.data(), &layout, sizeof(layout));
+    return request;
+}
+}  // namespace tests
@@ -0,0 +1,16 @@
+#pragma once
+
+// system includes
+#include <array>
+#include <cstdint>
+
+// local includes
+#include "server/packetlayout.h"
+
+//--------------------------------------------------------------------------------------------------
+
+namespace tests
+{
+// Builds a slot based pad data request for the pad at the index
+std::array<std::uint8_t, sizeof(server::PadDataRequestLayout)> makePadDataRequest(std::uint8_t index);
+}  // namespace tests
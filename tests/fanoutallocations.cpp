@@ -0,0 +1,132 @@
+// system includes
+#include <array>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/trivial.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+// local includes
+#include "allocationcounter.h"
+#include "dsurequests.h"
+#include "server/packetlayout.h"
+#include "server/serverworker.h"
+
+//--------------------------------------------------------------------------------------------------
+
+// Checks that sending out a pad update (ServerWorker::notify -> PadDataMailbox::post -> distributePadData) does not
+// allocate anything once the server has warmed up.
+
+//--------------------------------------------------------------------------------------------------
+
+namespace
+{
+using namespace std::chrono_literals;
+
+constexpr std::size_t WARMUP_UPDATES{1000};
+constexpr std::size_t MEASURED_UPDATES{10000};
+constexpr auto        RECEIVE_TIMEOUT{1s};
+
+//--------------------------------------------------------------------------------------------------
+
+bool receivePadData(boost::asio::ip::udp::socket& socket)
+{
+    const auto deadline{std::chrono::steady_clock::now() + RECEIVE_TIMEOUT};
+    while (socket.available() == 0)
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+        {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+
+    std::array<std::uint8_t, sizeof(server::PadDataResponseLayout)> response;
+    return socket.receive(boost::asio::buffer(response)) == response.size();
+}
+}  // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+int main()
+{
+    boost::log::core::get()->set_filter(boost::log::trivial::severity >= boost::log::trivial::warning);
+
+    shared::GamepadDataSnapshots gamepad_data;
+    server::NetworkSettings      network_settings;
+    server::ClientSettings       client_settings;
+    server::BroadcastSettings    broadcast_settings;
+
+    // Port 0 lets the OS pick a free port
+    server::ServerWorker worker{1, 0, false, gamepad_data, network_settings, client_settings, broadcast_settings,
+                                []() {}};
+    std::thread          worker_thread{[&worker]() { worker.run(); }};
+
+    int exit_code{EXIT_SUCCESS};
+    try
+    {
+        const auto                     loopback{boost::asio::ip::address_v4::loopback()};
+        boost::asio::io_context        client_context;
+        boost::asio::ip::udp::socket   client{client_context, boost::asio::ip::udp::endpoint{loopback, 0}};
+        boost::asio::ip::udp::endpoint server_endpoint{loopback, worker.getLocalEndpoint().port()};
+
+        client.send_to(boost::asio::buffer(tests::makePadDataRequest(0)), server_endpoint);
+        const auto deadline{std::chrono::steady_clock::now() + RECEIVE_TIMEOUT};
+        while (worker.getNumberOfClients() == 0 && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::yield();
+        }
+
+        // Both the coalesced and the immediate (held) updates are sent out
+        shared::GamepadDataContainer pads;
+        shared::PortInfoGenerations  port_info_generations;
+        pads[0].emplace();
+        const auto send_update = [&](std::size_t update)
+        {
+            const auto priority{update % 3 == 0 ? shared::UpdatePriority::Immediate
+                                                : shared::UpdatePriority::Coalesced};
+            pads[0]->m_pad_info.m_update_ts = update;
+            pads[0]->m_abxy.m_a             = update % 2 == 0;
+            gamepad_data.publish(0, pads[0], port_info_generations, priority);
+            worker.notify(0, priority);
+            return receivePadData(client);
+        };
+
+        for (std::size_t update = 0; update < WARMUP_UPDATES; ++update)
+        {
+            if (!send_update(update))
+            {
+                throw std::runtime_error{"Did not receive the pad data while warming up"};
+            }
+        }
+
+        const auto allocations_before{tests::getAllocationCount()};
+        for (std::size_t update = WARMUP_UPDATES; update < WARMUP_UPDATES + MEASURED_UPDATES; ++update)
+        {
+            if (!send_update(update))
+            {
+                throw std::runtime_error{"Did not receive the pad data"};
+            }
+        }
+        const auto allocations{tests::getAllocationCount() - allocations_before};
+
+        std::cout << "Allocations for " << MEASURED_UPDATES << " pad updates: " << allocations << std::endl;
+        if (allocations != 0)
+        {
+            exit_code = EXIT_FAILURE;
+        }
+    }
+    catch (const std::exception& exception)
+    {
+        std::cout << exception.what() << std::endl;
+        exit_code = EXIT_FAILURE;
+    }
+
+    worker.stop();
+    worker_thread.join();
+    return exit_code;
+}
@@ -0,0 +1,251 @@
+// class header include
+#include "fanoutmeasurement.h"
+
+// system includes
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+// local includes
+#include "server/serverworker.h"
+
+//--------------------------------------------------------------------------------------------------
+
+namespace
+{
+using namespace std::chrono_literals;
+
+constexpr std::size_t WARMUP_UPDATES{100};
+constexpr auto        RECEIVE_TIMEOUT{1000ms};
+constexpr auto        CONDITION_CHECK_INTERVAL{1ms};
+constexpr auto        REGISTRATION_INTERVAL{100ms};
+constexpr std::size_t REGISTRATION_ATTEMPTS{20};
+}  // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+namespace tests
+{
+double FanOutResult::getUpdatesPerSecond() const
+{
+    return static_cast<double>(m_updates) / m_elapsed.count();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+double FanOutResult::getPacketsPerSecond() const
+{
+    return static_cast<double>(m_packets) / m_elapsed.count();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool waitUntil(const std::function<bool()>& condition, std::chrono::milliseconds timeout)
+{
+    const auto deadline{std::chrono::steady_clock::now() + timeout};
+    while (!condition())
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(CONDITION_CHECK_INTERVAL);
+    }
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void registerClients(LoopbackClients& clients, std::uint16_t port, const std::function<std::size_t()>& count_clients)
+{
+    for (std::size_t attempt = 0; attempt < REGISTRATION_ATTEMPTS; ++attempt)
+    {
+        clients.requestPadData(port, 0);
+        if (waitUntil([&]() { return count_clients() == clients.getCount(); }, REGISTRATION_INTERVAL))
+        {
+            return;
+        }
+    }
+
+    throw std::runtime_error{"Not all of the clients have been registered"};
+}
+
+//--------------------------------------------------------------------------------------------------
+
+FanOutResult measureFanOut(shared::GamepadDataSnapshots& gamepad_data, const std::function<void()>& notify,
+                           LoopbackClients& clients, std::chrono::milliseconds duration)
+{
+    const std::size_t max_receivers{std::min<std::size_t>(4, clients.getCount())};
+    const std::size_t receivers{std::clamp<std::size_t>(std::thread::hardware_concurrency() / 2, 1, max_receivers)};
+
+    // Each receiver waits for the next update to be published, receives it on its share of the clients and reports
+    // back, so there is only ever one update in flight
+    std::atomic<std::size_t> published{0};
+    std::atomic<std::size_t> received{0};
+    std::atomic<bool>        failed{false};
+    std::atomic<bool>        stopping{false};
+
+    std::vector<std::thread> threads;
+    for (std::size_t receiver = 0; receiver < receivers; ++receiver)
+    {
+        threads.emplace_back(
+            [&, receiver]()
+            {
+                const std::size_t begin{clients.getCount() * receiver / receivers};
+                const std::size_t end{clients.getCount() * (receiver + 1) / receivers};
+                for (std::size_t update = 1;; ++update)
+                {
+                    published.wait(update - 1);
+                    if (stopping)
+                    {
+                        return;
+                    }
+
+                    if (!clients.receive(begin, end, RECEIVE_TIMEOUT))
+                    {
+                        failed = true;
+                    }
+
+                    ++received;
+                    received.notify_all();
+                }
+            });
+    }
+
+    shared::GamepadDataContainer pads;
+    shared::PortInfoGenerations  port_info_generations;
+    pads[0].emplace();
+
+    const auto send_update = [&](std::size_t update)
+    {
+        pads[0]->m_pad_info.m_update_ts = update;
+        pads[0]->m_abxy.m_a             = update % 2 == 0;
+        gamepad_data.publish(0, pads[0], port_info_generations, shared::UpdatePriority::Immediate);
+
+        ++published;
+        published.notify_all();
+        notify();
+
+        const std::size_t expected{update * receivers};
+        for (std::size_t value = received; value < expected; value = received)
+        {
+            received.wait(value);
+        }
+        return !failed;
+    };
+
+    FanOutResult result{};
+    std::size_t  update{1};
+    while (update <= WARMUP_UPDATES && send_update(update))
+    {
+        ++update;
+    }
+
+    const auto start{std::chrono::steady_clock::now()};
+    while (!failed && std::chrono::steady_clock::now() - start < duration)
+    {
+        send_update(update++);
+        ++result.m_updates;
+    }
+    result.m_elapsed = std::chrono::steady_clock::now() - start;
+    result.m_packets = result.m_updates * clients.getCount();
+
+    stopping = true;
+    ++published;
+    published.notify_all();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    if (failed)
+    {
+        throw std::runtime_error{"Not all of the clients have received the pad updates"};
+    }
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+FanOutResult measureServerFanOut(const server::NetworkSettings& network_settings, std::size_t number_of_clients,
+                                 std::chrono::milliseconds duration)
+{
+    shared::GamepadDataSnapshots gamepad_data;
+    server::ClientSettings       client_settings;
+    server::BroadcastSettings    broadcast_settings;
+
+    client_settings.m_max_clients             = number_of_clients;
+    client_settings.m_max_clients_per_address = number_of_clients;
+
+    // The first worker lets the OS pick a free port, the others share it
+    const bool                                         reuse_port{network_settings.m_workers > 1};
+    std::vector<std::unique_ptr<server::ServerWorker>> workers;
+    std::uint16_t                                      port{0};
+    for (std::size_t i = 0; i < network_settings.m_workers; ++i)
+    {
+        workers.push_back(std::make_unique<server::ServerWorker>(
+            1, port, reuse_port, gamepad_data, network_settings, client_settings, broadcast_settings, []() {}));
+        port = workers.front()->getLocalEndpoint().port();
+    }
+
+    std::vector<std::thread> threads;
+    for (auto& worker : workers)
+    {
+        threads.emplace_back([&worker]() { worker->run(); });
+    }
+
+    const auto stop_all = [&workers, &threads]()
+    {
+        for (auto& worker : workers)
+        {
+            worker->stop();
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    };
+
+    FanOutResult result{};
+    try
+    {
+        LoopbackClients clients{number_of_clients};
+        registerClients(clients, port,
+                        [&workers]()
+                        {
+                            std::size_t count{0};
+                            for (const auto& worker : workers)
+                            {
+                                count += worker->getNumberOfClients();
+                            }
+                            return count;
+                        });
+
+        result = measureFanOut(
+            gamepad_data,
+            [&workers]()
+            {
+                for (auto& worker : workers)
+                {
+                    worker->notify(0, shared::UpdatePriority::Immediate);
+                }
+            },
+            clients, duration);
+
+        for (const auto& worker : workers)
+        {
+            result.m_clients_per_worker.push_back(worker->getNumberOfClients());
+        }
+    }
+    catch (...)
+    {
+        stop_all();
+        throw;
+    }
+
+    stop_all();
+    return result;
+}
+}  // namespace tests
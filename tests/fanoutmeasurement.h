@@ -0,0 +1,56 @@
+#pragma once
+
+// system includes
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// local includes
+#include "loopbackclients.h"
+#include "server/networksettings.h"
+#include "shared/gamepaddatasnapshots.h"
+
+//--------------------------------------------------------------------------------------------------
+
+namespace tests
+{
+struct FanOutResult
+{
+    std::size_t                   m_updates;
+    std::size_t                   m_packets;
+    std::chrono::duration<double> m_elapsed;
+    std::vector<std::size_t>      m_clients_per_worker;  // Only set by `measureServerFanOut`
+
+    double getUpdatesPerSecond() const;
+    double getPacketsPerSecond() const;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+// Waits until the condition holds, returns false on timeout
+bool waitUntil(const std::function<bool()>& condition, std::chrono::milliseconds timeout);
+
+//--------------------------------------------------------------------------------------------------
+
+// Requests the data of pad 0 from each of the clients until the server has registered all of them, throws on timeout.
+// The requests are repeated, since the socket buffer of the server does not take hundreds of them at once.
+void registerClients(LoopbackClients& clients, std::uint16_t port, const std::function<std::size_t()>& count_clients);
+
+//--------------------------------------------------------------------------------------------------
+
+// Measures how fast the server sends out the pad updates: publishes an update of pad 0, calls `notify` and waits until
+// each of the clients (which have requested pad 0) has received it, over and over for the duration. The clients are
+// received on multiple threads, so that the receiving side is less of a bottleneck. Throws if any of the clients does
+// not receive an update.
+FanOutResult measureFanOut(shared::GamepadDataSnapshots& gamepad_data, const std::function<void()>& notify,
+                           LoopbackClients& clients, std::chrono::milliseconds duration);
+
+//--------------------------------------------------------------------------------------------------
+
+// Starts the server workers (as many as the settings ask for, sharing a port picked by the OS), registers the number
+// of clients with them and measures the fan-out (see `measureFanOut`)
+FanOutResult measureServerFanOut(const server::NetworkSettings& network_settings, std::size_t number_of_clients,
+                                 std::chrono::milliseconds duration);
+}  // namespace tests
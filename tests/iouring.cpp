@@ -0,0 +1,192 @@
+// system includes
+#include <algorithm>
+#include <array>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/trivial.hpp>
+#include <chrono>
+#include <cstring>
+#include <span>
+#include <sys/socket.h>
+#include <vector>
+
+// local includes
+#include "check.h"
+#include "server/batchreceiver.h"
+#include "server/batchsender.h"
+#include "shared/coroutines.h"
+
+//--------------------------------------------------------------------------------------------------
+
+// Checks that datagrams are sent and received through the io_uring backend (and that it does not fall back to the
+// default one on the way). Skipped if io_uring can not be set up, e.g. on older kernels or where it is disabled.
+
+//--------------------------------------------------------------------------------------------------
+
+namespace
+{
+using namespace std::chrono_literals;
+
+constexpr int         SKIPPED{77};  // See SKIP_RETURN_CODE in CMakeLists.txt
+constexpr auto        TIMEOUT{5s};
+constexpr std::size_t ROUNDS{3};                 // Goes through the buffer ring of the receiver more than once
+constexpr std::size_t DATAGRAMS_PER_ROUND{100};  // More than a single receive batch
+constexpr std::size_t SENT_PACKETS{300};         // More than the submission queue of the sender takes at once
+constexpr std::size_t CLIENTS{4};
+
+//--------------------------------------------------------------------------------------------------
+
+// Fills the datagram with a pattern that identifies it, its size varies with the number
+std::vector<std::uint8_t> makeDatagram(std::size_t number)
+{
+    std::vector<std::uint8_t> datagram(20 + number % 81);
+    for (std::size_t i = 0; i < datagram.size(); ++i)
+    {
+        datagram[i] = static_cast<std::uint8_t>(number + i * 7);
+    }
+    datagram[0] = static_cast<std::uint8_t>(number);
+    datagram[1] = static_cast<std::uint8_t>(number >> 8);
+    return datagram;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::size_t getNumber(std::span<const std::uint8_t> datagram)
+{
+    return datagram.size() < 2 ? 0 : datagram[0] | static_cast<std::size_t>(datagram[1]) << 8;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+boost::asio::awaitable<void> checkReceive(server::BatchReceiver& receiver, boost::asio::ip::udp::socket& client,
+                                          const boost::asio::ip::udp::endpoint& server_endpoint)
+{
+    for (std::size_t round = 0; round < ROUNDS; ++round)
+    {
+        const std::size_t first{round * DATAGRAMS_PER_ROUND};
+        for (std::size_t number = first; number < first + DATAGRAMS_PER_ROUND; ++number)
+        {
+            client.send_to(boost::asio::buffer(makeDatagram(number)), server_endpoint);
+        }
+
+        std::vector<bool> received(DATAGRAMS_PER_ROUND);
+        std::size_t       mismatches{0};
+        std::size_t       count{0};
+        while (count < DATAGRAMS_PER_ROUND)
+        {
+            for (const auto& datagram : co_await receiver.receive())
+            {
+                const auto number{getNumber(datagram.m_data)};
+                const auto expected{makeDatagram(number)};
+                if (number < first || number >= first + DATAGRAMS_PER_ROUND || received[number - first]
+                    || datagram.m_endpoint != client.local_endpoint()
+                    || !std::equal(datagram.m_data.begin(), datagram.m_data.end(), expected.begin(), expected.end()))
+                {
+                    ++mismatches;
+                    continue;
+                }
+
+                received[number - first] = true;
+                ++count;
+            }
+        }
+        TEST_CHECK(mismatches == 0);
+    }
+
+    TEST_CHECK(receiver.isUsingIoUring());
+}
+
+//--------------------------------------------------------------------------------------------------
+
+boost::asio::awaitable<void> checkSend(server::BatchSender& sender, std::vector<boost::asio::ip::udp::socket>& clients)
+{
+    for (std::size_t number = 0; number < SENT_PACKETS; ++number)
+    {
+        const auto datagram{makeDatagram(number)};
+        const auto storage{sender.queue(clients[number % clients.size()].local_endpoint(), datagram.size())};
+        std::memcpy(storage.data(), datagram.data(), datagram.size());
+    }
+    co_await sender.flush();
+    TEST_CHECK(sender.isUsingIoUring());
+
+    // The completions are only reported once the datagrams have been handed over to the loopback interface
+    std::vector<bool>                                              received(SENT_PACKETS);
+    std::size_t                                                    mismatches{0};
+    std::array<std::uint8_t, server::BatchSender::MAX_PACKET_SIZE> buffer;
+    for (std::size_t i = 0; i < clients.size(); ++i)
+    {
+        for (;;)
+        {
+            const auto size{::recv(clients[i].native_handle(), buffer.data(), buffer.size(), MSG_DONTWAIT)};
+            if (size < 0)
+            {
+                break;
+            }
+
+            const std::span<const std::uint8_t> datagram{buffer.data(), static_cast<std::size_t>(size)};
+            const auto                          number{getNumber(datagram)};
+            const auto                          expected{makeDatagram(number)};
+            if (number >= SENT_PACKETS || number % clients.size() != i || received[number]
+                || !std::equal(datagram.begin(), datagram.end(), expected.begin(), expected.end()))
+            {
+                ++mismatches;
+                continue;
+            }
+            received[number] = true;
+        }
+    }
+
+    TEST_CHECK(mismatches == 0);
+    TEST_CHECK(std::find(received.begin(), received.end(), false) == received.end());
+}
+}  // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+int main()
+{
+    boost::log::core::get()->set_filter(boost::log::trivial::severity >= boost::log::trivial::warning);
+
+    const auto                   loopback{boost::asio::ip::address_v4::loopback()};
+    boost::asio::io_context      io_context{1};
+    boost::asio::ip::udp::socket socket{io_context, {loopback, 0}};
+
+    server::NetworkSettings settings;
+    settings.m_io_uring = true;
+
+    server::BatchReceiver receiver{socket, settings};
+    server::BatchSender   sender{socket, settings};
+    if (!receiver.isUsingIoUring() || !sender.isUsingIoUring())
+    {
+        std::cout << "io_uring is not available, skipping" << std::endl;
+        return SKIPPED;
+    }
+
+    std::vector<boost::asio::ip::udp::socket> clients;
+    for (std::size_t i = 0; i < CLIENTS; ++i)
+    {
+        clients.emplace_back(io_context, boost::asio::ip::udp::endpoint{loopback, 0});
+    }
+
+    bool finished{false};
+    boost::asio::co_spawn(
+        io_context,
+        [&]() -> boost::asio::awaitable<void>
+        {
+            co_await checkReceive(receiver, clients.front(), socket.local_endpoint());
+            co_await checkSend(sender, clients);
+            finished = true;
+            io_context.stop();
+        },
+        shared::exceptionHandler);
+
+    boost::asio::steady_timer timeout_timer{io_context, TIMEOUT};
+    timeout_timer.async_wait([&io_context](const auto&) { io_context.stop(); });
+    io_context.run();
+
+    TEST_CHECK(finished);
+    return tests::getExitCode();
+}
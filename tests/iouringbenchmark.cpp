@@ -0,0 +1,57 @@
+// system includes
+#include <boost/log/core.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/trivial.hpp>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+// local includes
+#include "fanoutmeasurement.h"
+
+//--------------------------------------------------------------------------------------------------
+
+// Compares the pad data throughput of the io_uring backend against the default (Asio and `sendmmsg`) one, with a few
+// hundred clients on the loopback interface and a single worker. A warning is logged if io_uring falls back to the
+// default backend, in which case its numbers are meaningless.
+
+//--------------------------------------------------------------------------------------------------
+
+namespace
+{
+using namespace std::chrono_literals;
+
+constexpr auto DURATION{2000ms};
+}  // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+int main()
+{
+    boost::log::core::get()->set_filter(boost::log::trivial::severity >= boost::log::trivial::warning);
+
+    try
+    {
+        for (const std::size_t clients : {128, 256, 512})
+        {
+            for (const bool io_uring : {false, true})
+            {
+                server::NetworkSettings network_settings;
+                network_settings.m_io_uring = io_uring;
+
+                const auto result{tests::measureServerFanOut(network_settings, clients, DURATION)};
+                std::cout << std::fixed << std::setprecision(2) << "Clients: " << std::setw(3) << clients
+                          << ", backend: " << (io_uring ? "io_uring" : "default ")
+                          << ", updates/s: " << std::setw(10) << result.getUpdatesPerSecond()
+                          << ", packets/s: " << std::setw(12) << result.getPacketsPerSecond() << std::endl;
+            }
+        }
+    }
+    catch (const std::exception& exception)
+    {
+        std::cout << exception.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
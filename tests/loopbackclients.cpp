@@ -0,0 +1,94 @@
+// class header include
+#include "loopbackclients.h"
+
+// system includes
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <poll.h>
+#include <sys/socket.h>
+
+// local includes
+#include "dsurequests.h"
+#include "server/packetlayout.h"
+
+//--------------------------------------------------------------------------------------------------
+
+namespace tests
+{
+LoopbackClients::LoopbackClients(std::size_t count)
+    : m_io_context{1}
+{
+    const auto loopback{boost::asio::ip::address_v4::loopback()};
+
+    m_sockets.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        m_sockets.emplace_back(m_io_context, boost::asio::ip::udp::endpoint{loopback, 0});
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::size_t LoopbackClients::getCount() const
+{
+    return m_sockets.size();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void LoopbackClients::requestPadData(std::uint16_t port, std::uint8_t index)
+{
+    const auto                           request{makePadDataRequest(index)};
+    const boost::asio::ip::udp::endpoint server_endpoint{boost::asio::ip::address_v4::loopback(), port};
+    for (auto& socket : m_sockets)
+    {
+        socket.send_to(boost::asio::buffer(request), server_endpoint);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool LoopbackClients::receive(std::size_t begin, std::size_t end, std::chrono::milliseconds timeout)
+{
+    std::vector<pollfd> pending;
+    pending.reserve(end - begin);
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        pending.push_back({m_sockets[i].native_handle(), POLLIN, 0});
+    }
+
+    std::array<std::uint8_t, sizeof(server::PadDataResponseLayout)> buffer;
+    const auto deadline{std::chrono::steady_clock::now() + timeout};
+    while (!pending.empty())
+    {
+        const auto remaining{
+            std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now())};
+        if (remaining.count() <= 0)
+        {
+            return false;
+        }
+
+        if (::poll(pending.data(), pending.size(), static_cast<int>(remaining.count())) < 0 && errno != EINTR)
+        {
+            return false;
+        }
+
+        std::erase_if(pending,
+                      [&buffer](const pollfd& client)
+                      {
+                          if ((client.revents & POLLIN) == 0)
+                          {
+                              return false;
+                          }
+
+                          while (::recv(client.fd, buffer.data(), buffer.size(), MSG_DONTWAIT) > 0)
+                          {
+                          }
+                          return true;
+                      });
+    }
+
+    return true;
+}
+}  // namespace tests
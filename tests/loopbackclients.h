@@ -0,0 +1,40 @@
+#pragma once
+
+// system includes
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/move/core.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// local includes
+
+//--------------------------------------------------------------------------------------------------
+
+namespace tests
+{
+// DSU clients on the loopback interface, each with a socket (and port) of its own, so the server sees them as separate
+// clients (POSIX only).
+class LoopbackClients final
+{
+    BOOST_MOVABLE_BUT_NOT_COPYABLE(LoopbackClients)
+
+public:
+    explicit LoopbackClients(std::size_t count);
+
+    std::size_t getCount() const;
+
+    // Sends the pad data request for the pad at the index from each of the clients
+    void requestPadData(std::uint16_t port, std::uint8_t index);
+
+    // Waits until each of the clients in [begin, end) has received a packet (and drains them), returns false on
+    // timeout. Note: can be called from multiple threads for separate ranges.
+    bool receive(std::size_t begin, std::size_t end, std::chrono::milliseconds timeout);
+
+private:
+    boost::asio::io_context                   m_io_context;
+    std::vector<boost::asio::ip::udp::socket> m_sockets;
+};
+}  // namespace tests
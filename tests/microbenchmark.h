@@ -0,0 +1,47 @@
+#pragma once
+
+// system includes
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// local includes
+
+//--------------------------------------------------------------------------------------------------
+
+namespace tests
+{
+inline volatile std::uint64_t g_benchmark_sink{0};
+
+//--------------------------------------------------------------------------------------------------
+
+// Stores the result where the compiler can not optimise it (and its calculation) away
+inline void keepResult(std::uint64_t value)
+{
+    g_benchmark_sink = value;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Calls the function (with the number of the call) over and over and returns the average duration of a call, taken
+// from the fastest of a few runs to filter out the noise of the other processes
+template<class Function>
+std::chrono::duration<double, std::nano> measureCall(std::size_t calls, Function&& function)
+{
+    constexpr std::size_t RUNS{5};
+
+    std::chrono::duration<double, std::nano> fastest{std::chrono::duration<double, std::nano>::max()};
+    for (std::size_t run = 0; run < RUNS; ++run)
+    {
+        const auto start{std::chrono::steady_clock::now()};
+        for (std::size_t call = 0; call < calls; ++call)
+        {
+            function(call);
+        }
+        const std::chrono::duration<double, std::nano> elapsed{std::chrono::steady_clock::now() - start};
+        fastest = std::min(fastest, elapsed / static_cast<double>(calls));
+    }
+    return fastest;
+}
+}  // namespace tests
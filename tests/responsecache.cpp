@@ -0,0 +1,78 @@
+// system includes
+#include <cstring>
+
+// local includes
+#include "check.h"
+#include "server/common.h"
+#include "server/packetlayout.h"
+#include "server/responsecache.h"
+
+//--------------------------------------------------------------------------------------------------
+
+// Checks that the cached list ports responses follow the port info of each pad.
+
+//--------------------------------------------------------------------------------------------------
+
+namespace
+{
+using shared::details::BatteryLevel;
+
+//--------------------------------------------------------------------------------------------------
+
+server::ControllerHeader getController(server::ResponseCache& cache, std::uint8_t index)
+{
+    server::ListPortsResponseLayout layout;
+    std::memcpy(&layout, cache.getListPortsResponse(index).data(), sizeof(layout));
+    return layout.m_controller;
+}
+}  // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+int main()
+{
+    shared::GamepadDataSnapshots gamepad_data;
+    shared::GamepadDataContainer pads;
+    shared::PortInfoGenerations  port_info_generations;
+    server::ResponseCache        cache{1, gamepad_data};
+
+    // Nothing connected yet
+    TEST_CHECK(getController(cache, 0).m_state == 0x00);
+    TEST_CHECK(getController(cache, 1).m_state == 0x00);
+
+    // Connecting a pad is picked up
+    for (std::uint8_t index = 0; index < 2; ++index)
+    {
+        pads[index] = shared::GamepadData{.m_pad_info = {index}, .m_battery = BatteryLevel::Full};
+        ++port_info_generations.m_values[index];
+        gamepad_data.publish(index, pads[index], port_info_generations, shared::UpdatePriority::Immediate);
+    }
+    TEST_CHECK(getController(cache, 0).m_state == 0x02);
+    TEST_CHECK(getController(cache, 1).m_state == 0x02);
+    TEST_CHECK(getController(cache, 1).m_battery == server::enumToValue(BatteryLevel::Full));
+
+    // The battery of pad 1 changes within the same input batch as an update of pad 0, which is published first. The
+    // response of pad 1 must not be cached as up to date, before the change has been published.
+    pads[1]->m_battery = BatteryLevel::Low;
+    ++port_info_generations.m_values[1];
+    gamepad_data.publish(0, pads[0], port_info_generations, shared::UpdatePriority::Coalesced);
+    TEST_CHECK(getController(cache, 1).m_battery == server::enumToValue(BatteryLevel::Full));
+
+    gamepad_data.publish(1, pads[1], port_info_generations, shared::UpdatePriority::Coalesced);
+    TEST_CHECK(getController(cache, 1).m_battery == server::enumToValue(BatteryLevel::Low));
+    TEST_CHECK(getController(cache, 0).m_battery == server::enumToValue(BatteryLevel::Full));
+
+    // Updates that do not change the port info keep the cached response
+    pads[0]->m_battery = BatteryLevel::Empty;
+    gamepad_data.publish(0, pads[0], port_info_generations, shared::UpdatePriority::Coalesced);
+    TEST_CHECK(getController(cache, 0).m_battery == server::enumToValue(BatteryLevel::Full));
+
+    // Disconnecting a pad is picked up
+    pads[0] = std::nullopt;
+    ++port_info_generations.m_values[0];
+    gamepad_data.publish(0, pads[0], port_info_generations, shared::UpdatePriority::Immediate);
+    TEST_CHECK(getController(cache, 0).m_state == 0x00);
+    TEST_CHECK(getController(cache, 1).m_state == 0x02);
+
+    return tests::getExitCode();
+}
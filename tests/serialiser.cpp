@@ -0,0 +1,204 @@
+// system includes
+#include <algorithm>
+#include <array>
+#include <boost/log/core.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/trivial.hpp>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <random>
+#include <span>
+
+// local includes
+#include "check.h"
+#include "server/crc32.h"
+#include "server/packetlayout.h"
+#include "server/serialiser.h"
+
+//--------------------------------------------------------------------------------------------------
+
+// Checks the serialised responses against the bytes that the DSU protocol expects (written out by hand, the CRC32
+// included), so that any change of the packet layouts that alters the wire format is caught. The CRC32 patched by
+// `updatePacketCounter` must match a full recalculation for any counter.
+
+//--------------------------------------------------------------------------------------------------
+
+namespace
+{
+constexpr std::uint32_t SERVER_ID{0x12345678};
+
+//--------------------------------------------------------------------------------------------------
+
+// Every field gets a value that differs from its neighbours, so that swapped or shifted fields show up
+shared::GamepadData makeGamepadData()
+{
+    shared::GamepadData gamepad_data{.m_pad_info = {1}, .m_battery = shared::details::BatteryLevel::Full};
+    gamepad_data.m_abxy        = {.m_a = true, .m_y = true};
+    gamepad_data.m_dpad        = {.m_up = true, .m_left = true};
+    gamepad_data.m_special     = {.m_guide = true, .m_start = true};
+    gamepad_data.m_shoulder    = {.m_left = true};
+    gamepad_data.m_trigger     = {.m_left = 0x40, .m_right = 0xFF};
+    gamepad_data.m_left_stick  = {.m_pressed = true, .m_x = 0x12, .m_y = 0x34};
+    gamepad_data.m_right_stick = {.m_x = 0x56, .m_y = 0x78};
+    gamepad_data.m_touchpad    = {.m_pressed      = true,
+                                  .m_first_touch  = {.m_touched = true, .m_id = 3, .m_x = 0x0123, .m_y = 0x0456},
+                                  .m_second_touch = {.m_id = 4, .m_x = 0x0007, .m_y = 0x0008}};
+    gamepad_data.m_sensor      = {.m_accel = {0.5f, -1.f, 2.f},
+                                  .m_gyro  = {90.f, -45.25f, 1.5f},
+                                  .m_ts    = 0x0102030405060708};
+    return gamepad_data;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+template<std::size_t size>
+bool isSame(const std::array<std::uint8_t, size>& data, const std::array<std::uint8_t, size>& expected)
+{
+    return std::equal(data.begin(), data.end(), expected.begin());
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void checkVersion()
+{
+    constexpr std::array<std::uint8_t, server::VERSION_RESPONSE_SIZE> expected{
+        0x44, 0x53, 0x55, 0x53,  // Magic "DSUS"
+        0xE9, 0x03,              // Protocol version 1001
+        0x08, 0x00,              // Packet size without the header
+        0xFB, 0x24, 0xA7, 0x81,  // CRC32
+        0x78, 0x56, 0x34, 0x12,  // Server id
+        0x00, 0x00, 0x10, 0x00,  // Message type
+        0xE9, 0x03, 0x00, 0x00,  // Protocol version 1001
+    };
+
+    std::array<std::uint8_t, server::VERSION_RESPONSE_SIZE> data;
+    server::serialise(server::VersionResponse{}, SERVER_ID, data);
+    TEST_CHECK(isSame(data, expected));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void checkListPorts()
+{
+    constexpr std::array<std::uint8_t, server::LIST_PORTS_RESPONSE_SIZE> expected_connected{
+        0x44, 0x53, 0x55, 0x53, 0xE9, 0x03, 0x10, 0x00, 0x6D, 0x33, 0x94, 0x31,  // Magic, version, size, CRC32
+        0x78, 0x56, 0x34, 0x12, 0x01, 0x00, 0x10, 0x00,                          // Server id, message type
+        0x01,                                                                    // Slot
+        0x02,                                                                    // State: connected
+        0x02,                                                                    // Model: full gyro
+        0x02,                                                                    // Connection type: bluetooth
+        0x01, 0x00, 0x00, 0x00, 0x00, 0x00,                                      // MAC address
+        0x05,                                                                    // Battery: full
+        0x00,                                                                    // Trailing zero
+    };
+    constexpr std::array<std::uint8_t, server::LIST_PORTS_RESPONSE_SIZE> expected_disconnected{
+        0x44, 0x53, 0x55, 0x53, 0xE9, 0x03, 0x10, 0x00, 0xB0, 0x1F, 0x92, 0x90,  // Magic, version, size, CRC32
+        0x78, 0x56, 0x34, 0x12, 0x01, 0x00, 0x10, 0x00,                          // Server id, message type
+        0x03,                                                                    // Slot
+        0x00, 0x00, 0x00,                                                        // Not connected
+        0x03, 0x00, 0x00, 0x00, 0x00, 0x00,                                      // MAC address
+        0x00,                                                                    // Battery: unknown
+        0x00,                                                                    // Trailing zero
+    };
+
+    const std::optional<shared::GamepadData>                 connected{makeGamepadData()};
+    const std::optional<shared::GamepadData>                 disconnected;
+    std::array<std::uint8_t, server::LIST_PORTS_RESPONSE_SIZE> data;
+
+    server::serialise(server::ListPortsResponse{1, connected}, SERVER_ID, data);
+    TEST_CHECK(isSame(data, expected_connected));
+
+    server::serialise(server::ListPortsResponse{3, disconnected}, SERVER_ID, data);
+    TEST_CHECK(isSame(data, expected_disconnected));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void checkPadData()
+{
+    constexpr std::array<std::uint8_t, server::PAD_DATA_RESPONSE_SIZE> expected_connected{
+        0x44, 0x53, 0x55, 0x53, 0xE9, 0x03, 0x54, 0x00, 0xE7, 0x1E, 0xA5, 0x1F,  // Magic, version, size, CRC32
+        0x78, 0x56, 0x34, 0x12, 0x02, 0x00, 0x10, 0x00,                          // Server id, message type
+        0x01, 0x02, 0x02, 0x02, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x05,        // Same as in list ports
+        0x01,                                                                    // Connected
+        0xD4, 0xC3, 0xB2, 0xA1,                                                  // Packet counter
+        0x9A,                                                                    // Left, up, start, L3
+        0x56,                                                                    // A, Y, L1, full R2
+        0x01,                                                                    // Guide
+        0x01,                                                                    // Touchpad pressed
+        0x12, 0x34, 0x56, 0x78,                                                  // Sticks
+        0xFF, 0x00, 0x00, 0xFF,                                                  // D-pad left, down, right, up
+        0x00, 0xFF, 0x00, 0xFF,                                                  // X, A, B, Y
+        0x00, 0xFF,                                                              // R1, L1
+        0xFF, 0x40,                                                              // R2, L2
+        0x01, 0x03, 0x23, 0x01, 0x56, 0x04,                                      // First touch
+        0x00, 0x04, 0x07, 0x00, 0x08, 0x00,                                      // Second touch
+        0x08, 0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01,                          // Motion timestamp
+        0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x80, 0xBF, 0x00, 0x00, 0x00, 0x40,  // Accelerometer
+        0x00, 0x00, 0xB4, 0x42, 0x00, 0x00, 0x35, 0xC2, 0x00, 0x00, 0xC0, 0x3F,  // Gyroscope
+    };
+    constexpr std::array<std::uint8_t, server::PAD_DATA_RESPONSE_SIZE> expected_disconnected{
+        0x44, 0x53, 0x55, 0x53, 0xE9, 0x03, 0x54, 0x00, 0xD3, 0x07, 0xCC, 0xC6,  // Magic, version, size, CRC32
+        0x78, 0x56, 0x34, 0x12, 0x02, 0x00, 0x10, 0x00,                          // Server id, message type
+        0x03, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,        // Same as in list ports
+        0x00,                                                                    // Not connected
+        0x07, 0x00, 0x00, 0x00,                                                  // Packet counter
+        // The rest is zeroed out
+    };
+
+    const std::optional<shared::GamepadData>                 connected{makeGamepadData()};
+    const std::optional<shared::GamepadData>                 disconnected;
+    std::array<std::uint8_t, server::PAD_DATA_RESPONSE_SIZE> data;
+
+    server::serialise(server::PadDataResponse{1, connected}, SERVER_ID, data);
+    server::updatePacketCounter(data, 0xA1B2C3D4);
+    TEST_CHECK(isSame(data, expected_connected));
+
+    server::serialise(server::PadDataResponse{3, disconnected}, SERVER_ID, data);
+    server::updatePacketCounter(data, 7);
+    TEST_CHECK(isSame(data, expected_disconnected));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void checkPacketCounter()
+{
+    const std::optional<shared::GamepadData>                 gamepad_data{makeGamepadData()};
+    std::array<std::uint8_t, server::PAD_DATA_RESPONSE_SIZE> data;
+    server::serialise(server::PadDataResponse{1, gamepad_data}, SERVER_ID, data);
+
+    // Each update starts from the counter of the previous one
+    std::mt19937 random{1234};
+    std::size_t  failures{0};
+    for (int i = 0; i < 10000; ++i)
+    {
+        const std::uint32_t packet_counter{static_cast<std::uint32_t>(random())};
+        server::updatePacketCounter(data, packet_counter);
+
+        server::PadDataResponseLayout layout;
+        std::memcpy(&layout, data.data(), sizeof(layout));
+        const std::uint32_t crc{layout.m_header.m_crc32.get()};
+        layout.m_header.m_crc32 = 0;
+
+        const std::span<const std::uint8_t> bytes{reinterpret_cast<const std::uint8_t*>(&layout), sizeof(layout)};
+        const std::uint32_t                 expected_crc{server::calculateCrc32(bytes)};
+        failures += crc != expected_crc || layout.m_packet_counter.get() != packet_counter ? 1 : 0;
+    }
+    TEST_CHECK(failures == 0);
+}
+}  // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+int main()
+{
+    boost::log::core::get()->set_filter(boost::log::trivial::severity >= boost::log::trivial::warning);
+
+    checkVersion();
+    checkListPorts();
+    checkPadData();
+    checkPacketCounter();
+
+    return tests::getExitCode();
+}
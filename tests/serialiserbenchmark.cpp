@@ -0,0 +1,477 @@
+// system includes
+#include <algorithm>
+#include <array>
+#include <boost/assert.hpp>
+#include <boost/crc.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/trivial.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <vector>
+
+// local includes
+#include "microbenchmark.h"
+#include "server/common.h"
+#include "server/serialiser.h"
+
+//--------------------------------------------------------------------------------------------------
+
+// Measures the encoding of the responses with the fixed packet layouts against the previous encoder, which wrote the
+// fields byte by byte into freshly allocated vectors (kept below as it was, apart from taking a single pad for the
+// list ports response). Both of them must produce the same bytes before anything is measured.
+
+//--------------------------------------------------------------------------------------------------
+
+namespace legacy
+{
+using server::DsuMsgType;
+using server::enumToValue;
+using server::getProtocolVersion;
+
+//--------------------------------------------------------------------------------------------------
+
+struct PadDataResponse
+{
+    const std::uint8_t                        m_pad_index;
+    const std::optional<shared::GamepadData>& m_gamepad_data;
+    const std::uint32_t                       m_packet_counter;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+void writeUInt8(std::vector<std::uint8_t>& data, std::size_t& index, std::uint8_t value)
+{
+    BOOST_ASSERT(index < data.size());
+
+    data[index++] = value;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void writeUInt16LE(std::vector<std::uint8_t>& data, std::size_t& index, std::uint16_t value)
+{
+    BOOST_ASSERT(index + 1 < data.size());
+
+    data[index++] = static_cast<std::uint8_t>(value);
+    data[index++] = static_cast<std::uint8_t>(value >> 8);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void writeUInt32LE(std::vector<std::uint8_t>& data, std::size_t& index, std::uint32_t value)
+{
+    BOOST_ASSERT(index + 3 < data.size());
+
+    data[index++] = static_cast<std::uint8_t>(value);
+    data[index++] = static_cast<std::uint8_t>(value >> 8);
+    data[index++] = static_cast<std::uint8_t>(value >> 16);
+    data[index++] = static_cast<std::uint8_t>(value >> 24);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void writeUInt64LE(std::vector<std::uint8_t>& data, std::size_t& index, std::uint64_t value)
+{
+    BOOST_ASSERT(index + 7 < data.size());
+
+    data[index++] = static_cast<std::uint8_t>(value);
+    data[index++] = static_cast<std::uint8_t>(value >> 8);
+    data[index++] = static_cast<std::uint8_t>(value >> 16);
+    data[index++] = static_cast<std::uint8_t>(value >> 24);
+    data[index++] = static_cast<std::uint8_t>(value >> 32);
+    data[index++] = static_cast<std::uint8_t>(value >> 40);
+    data[index++] = static_cast<std::uint8_t>(value >> 48);
+    data[index++] = static_cast<std::uint8_t>(value >> 56);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void writeFloatLE(std::vector<std::uint8_t>& data, std::size_t& index, float value)
+{
+    static_assert(sizeof(std::uint32_t) == sizeof(float));
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeUInt32LE(data, index, bits);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::uint32_t calculateCrc32(const std::vector<std::uint8_t>& data)
+{
+    boost::crc_32_type crc;
+    crc.process_bytes(data.data(), data.size());
+    return crc.checksum();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::vector<std::uint8_t> finalizeResponse(const std::vector<std::uint8_t>& payload, std::uint32_t server_id,
+                                           DsuMsgType msg_type)
+{
+    std::size_t               index{0};
+    std::vector<std::uint8_t> data(20, 0);
+
+    // Header
+    writeUInt8(data, index, 'D');
+    writeUInt8(data, index, 'S');
+    writeUInt8(data, index, 'U');
+    writeUInt8(data, index, 'S');
+    writeUInt16LE(data, index, getProtocolVersion());
+    writeUInt16LE(data, index, static_cast<std::uint16_t>(payload.size()) + 4);
+    writeUInt32LE(data, index, 0x00 /* Reserved for CRC32 */);
+    writeUInt32LE(data, index, server_id);
+
+    // Msg type (adds 4 bytes to size)
+    writeUInt32LE(data, index, enumToValue(msg_type));
+
+    // Payload
+    std::copy(std::begin(payload), std::end(payload), std::back_inserter(data));
+
+    // Calculate CRC32
+    index = 8;
+    writeUInt32LE(data, index, calculateCrc32(data));
+
+    return data;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void serialiseGamepadHeader(const std::optional<shared::GamepadData>& gamepad_data, std::uint8_t pad_index,
+                            std::vector<std::uint8_t>& data, std::size_t& index)
+{
+    writeUInt8(data, index, pad_index);
+    if (gamepad_data)
+    {
+        writeUInt8(data, index, 0x02 /* connected */);
+        writeUInt8(data, index, gamepad_data->m_sensor.m_ts != 0 ? 0x02 : 0x00 /* gyro state */);
+        writeUInt8(data, index,
+                   gamepad_data->m_battery == shared::details::BatteryLevel::Wired ? 0x01 : 0x02 /* connection type */);
+    }
+    else
+    {
+        writeUInt8(data, index, 0x00 /* disconnected */);
+        writeUInt8(data, index, 0x00 /* no gyro yet */);
+        writeUInt8(data, index, 0x00 /* no connection type yet */);
+    }
+
+    writeUInt8(data, index, pad_index);
+    writeUInt8(data, index, 0x00);
+    writeUInt8(data, index, 0x00);
+    writeUInt8(data, index, 0x00);
+    writeUInt8(data, index, 0x00);
+    writeUInt8(data, index, 0x00);
+
+    if (gamepad_data)
+    {
+        writeUInt8(data, index, enumToValue(gamepad_data->m_battery));
+    }
+    else
+    {
+        writeUInt8(data, index, 0x00 /* no battery yet */);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void serialiseButtonFlagsA(const shared::GamepadData& gamepad_data, std::vector<std::uint8_t>& data, std::size_t& index)
+{
+    std::uint8_t flag{0};
+    if (gamepad_data.m_dpad.m_left)
+        flag |= 0x80;
+    if (gamepad_data.m_dpad.m_down)
+        flag |= 0x40;
+    if (gamepad_data.m_dpad.m_right)
+        flag |= 0x20;
+    if (gamepad_data.m_dpad.m_up)
+        flag |= 0x10;
+
+    if (gamepad_data.m_special.m_start)
+        flag |= 0x08;
+    if (gamepad_data.m_right_stick.m_pressed)
+        flag |= 0x04;
+    if (gamepad_data.m_left_stick.m_pressed)
+        flag |= 0x02;
+    if (gamepad_data.m_special.m_back)
+        flag |= 0x01;
+
+    writeUInt8(data, index, flag);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void serialiseButtonFlagsB(const shared::GamepadData& gamepad_data, std::vector<std::uint8_t>& data, std::size_t& index)
+{
+    std::uint8_t flag{0};
+    if (gamepad_data.m_abxy.m_x)
+        flag |= 0x80;
+    if (gamepad_data.m_abxy.m_a)
+        flag |= 0x40;
+    if (gamepad_data.m_abxy.m_b)
+        flag |= 0x20;
+    if (gamepad_data.m_abxy.m_y)
+        flag |= 0x10;
+
+    if (gamepad_data.m_shoulder.m_right)
+        flag |= 0x08;
+    if (gamepad_data.m_shoulder.m_left)
+        flag |= 0x04;
+    if (gamepad_data.m_trigger.m_right == 0xFF)
+        flag |= 0x02;
+    if (gamepad_data.m_trigger.m_left == 0xFF)
+        flag |= 0x01;
+
+    writeUInt8(data, index, flag);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void serialiseTouch(const shared::details::Touch& touch, std::vector<std::uint8_t>& data, std::size_t& index)
+{
+    writeUInt8(data, index, touch.m_touched ? 0x01 : 0x00);
+    writeUInt8(data, index, touch.m_id);
+    writeUInt16LE(data, index, touch.m_x);
+    writeUInt16LE(data, index, touch.m_y);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::vector<std::uint8_t> serialise(const server::VersionResponse&, std::uint32_t server_id)
+{
+    std::size_t               index{0};
+    std::vector<std::uint8_t> data(4, 0);
+
+    // Payload
+    writeUInt32LE(data, index, getProtocolVersion());
+
+    return finalizeResponse(data, server_id, DsuMsgType::Version);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::vector<std::uint8_t> serialise(const server::ListPortsResponse& response, std::uint32_t server_id)
+{
+    std::size_t               index{0};
+    std::vector<std::uint8_t> data(12, 0);
+
+    serialiseGamepadHeader(response.m_gamepad_data, response.m_pad_index, data, index);
+    writeUInt8(data, index, 0x00);  // Trailing 0 for some reason
+
+    return finalizeResponse(data, server_id, DsuMsgType::ListPorts);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::vector<std::uint8_t> serialise(const PadDataResponse& response, std::uint32_t server_id)
+{
+    std::size_t               index{0};
+    std::vector<std::uint8_t> data(80, 0);
+
+    serialiseGamepadHeader(response.m_gamepad_data, response.m_pad_index, data, index);
+
+    writeUInt8(data, index, response.m_gamepad_data ? 0x01 : 0x00);
+    writeUInt32LE(data, index, response.m_packet_counter);
+
+    // In case we have no data, the rest of fields can be left zero-ed out
+    if (response.m_gamepad_data)
+    {
+        const auto& gamepad_data{*response.m_gamepad_data};
+
+        serialiseButtonFlagsA(gamepad_data, data, index);
+        serialiseButtonFlagsB(gamepad_data, data, index);
+
+        writeUInt8(data, index, gamepad_data.m_special.m_guide ? 0x01 : 0x00);
+        writeUInt8(data, index, gamepad_data.m_touchpad.m_pressed ? 0x01 : 0x00);
+
+        writeUInt8(data, index, gamepad_data.m_left_stick.m_x);
+        writeUInt8(data, index, gamepad_data.m_left_stick.m_y);
+
+        writeUInt8(data, index, gamepad_data.m_right_stick.m_x);
+        writeUInt8(data, index, gamepad_data.m_right_stick.m_y);
+
+        writeUInt8(data, index, gamepad_data.m_dpad.m_left ? 0xFF : 0x00);
+        writeUInt8(data, index, gamepad_data.m_dpad.m_down ? 0xFF : 0x00);
+        writeUInt8(data, index, gamepad_data.m_dpad.m_right ? 0xFF : 0x00);
+        writeUInt8(data, index, gamepad_data.m_dpad.m_up ? 0xFF : 0x00);
+
+        writeUInt8(data, index, gamepad_data.m_abxy.m_x ? 0xFF : 0x00);
+        writeUInt8(data, index, gamepad_data.m_abxy.m_a ? 0xFF : 0x00);
+        writeUInt8(data, index, gamepad_data.m_abxy.m_b ? 0xFF : 0x00);
+        writeUInt8(data, index, gamepad_data.m_abxy.m_y ? 0xFF : 0x00);
+
+        writeUInt8(data, index, gamepad_data.m_shoulder.m_right ? 0xFF : 0x00);
+        writeUInt8(data, index, gamepad_data.m_shoulder.m_left ? 0xFF : 0x00);
+
+        writeUInt8(data, index, gamepad_data.m_trigger.m_right);
+        writeUInt8(data, index, gamepad_data.m_trigger.m_left);
+
+        serialiseTouch(gamepad_data.m_touchpad.m_first_touch, data, index);
+        serialiseTouch(gamepad_data.m_touchpad.m_second_touch, data, index);
+
+        writeUInt64LE(data, index, gamepad_data.m_sensor.m_ts);
+        writeFloatLE(data, index, gamepad_data.m_sensor.m_accel.m_x);
+        writeFloatLE(data, index, gamepad_data.m_sensor.m_accel.m_y);
+        writeFloatLE(data, index, gamepad_data.m_sensor.m_accel.m_z);
+        writeFloatLE(data, index, gamepad_data.m_sensor.m_gyro.m_pitch);
+        writeFloatLE(data, index, gamepad_data.m_sensor.m_gyro.m_yaw);
+        writeFloatLE(data, index, gamepad_data.m_sensor.m_gyro.m_roll);
+    }
+
+    return finalizeResponse(data, server_id, DsuMsgType::PadData);
+}
+}  // namespace legacy
+
+//--------------------------------------------------------------------------------------------------
+
+namespace
+{
+constexpr std::size_t   CALLS{1000000};
+constexpr std::uint32_t SERVER_ID{0x12345678};
+
+//--------------------------------------------------------------------------------------------------
+
+shared::GamepadData makeGamepadData()
+{
+    shared::GamepadData gamepad_data{.m_pad_info = {1}, .m_battery = shared::details::BatteryLevel::Full};
+    gamepad_data.m_abxy        = {.m_a = true, .m_y = true};
+    gamepad_data.m_dpad        = {.m_up = true, .m_left = true};
+    gamepad_data.m_special     = {.m_guide = true, .m_start = true};
+    gamepad_data.m_shoulder    = {.m_left = true};
+    gamepad_data.m_trigger     = {.m_left = 0x40, .m_right = 0xFF};
+    gamepad_data.m_left_stick  = {.m_pressed = true, .m_x = 0x12, .m_y = 0x34};
+    gamepad_data.m_right_stick = {.m_x = 0x56, .m_y = 0x78};
+    gamepad_data.m_touchpad    = {.m_pressed      = true,
+                                  .m_first_touch  = {.m_touched = true, .m_id = 3, .m_x = 0x0123, .m_y = 0x0456},
+                                  .m_second_touch = {.m_id = 4, .m_x = 0x0007, .m_y = 0x0008}};
+    gamepad_data.m_sensor      = {.m_accel = {0.5f, -1.f, 2.f},
+                                  .m_gyro  = {90.f, -45.25f, 1.5f},
+                                  .m_ts    = 0x0102030405060708};
+    return gamepad_data;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+template<std::size_t size>
+bool isSame(const std::vector<std::uint8_t>& expected, const std::array<std::uint8_t, size>& data)
+{
+    return std::equal(expected.begin(), expected.end(), data.begin(), data.end());
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void printResult(const std::string& name, std::chrono::duration<double, std::nano> legacy_duration,
+                 std::chrono::duration<double, std::nano> duration)
+{
+    std::cout << std::left << std::setw(26) << name << std::right << std::fixed << std::setprecision(2)
+              << "previous: " << std::setw(8) << legacy_duration.count() << " ns, current: " << std::setw(8)
+              << duration.count() << " ns, speedup: " << legacy_duration / duration << std::endl;
+}
+}  // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+int main()
+{
+    boost::log::core::get()->set_filter(boost::log::trivial::severity >= boost::log::trivial::warning);
+
+    const std::optional<shared::GamepadData> gamepad_data{makeGamepadData()};
+    const std::uint8_t                       pad_index{gamepad_data->m_pad_info.m_index};
+
+    std::array<std::uint8_t, server::VERSION_RESPONSE_SIZE>    version;
+    std::array<std::uint8_t, server::LIST_PORTS_RESPONSE_SIZE> list_ports;
+    std::array<std::uint8_t, server::PAD_DATA_RESPONSE_SIZE>   pad_data;
+    std::array<std::uint8_t, server::PAD_DATA_RESPONSE_SIZE>   client_pad_data;
+
+    server::serialise(server::VersionResponse{}, SERVER_ID, version);
+    server::serialise(server::ListPortsResponse{pad_index, gamepad_data}, SERVER_ID, list_ports);
+    server::serialise(server::PadDataResponse{pad_index, gamepad_data}, SERVER_ID, pad_data);
+    client_pad_data = pad_data;
+    server::updatePacketCounter(client_pad_data, 0xA1B2C3D4);
+
+    if (!isSame(legacy::serialise(server::VersionResponse{}, SERVER_ID), version)
+        || !isSame(legacy::serialise(server::ListPortsResponse{pad_index, gamepad_data}, SERVER_ID), list_ports)
+        || !isSame(legacy::serialise(legacy::PadDataResponse{pad_index, gamepad_data, 0}, SERVER_ID), pad_data)
+        || !isSame(legacy::serialise(legacy::PadDataResponse{pad_index, gamepad_data, 0xA1B2C3D4}, SERVER_ID),
+                   client_pad_data))
+    {
+        std::cout << "The encoders do not produce the same bytes" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    printResult(
+        "version:",
+        tests::measureCall(CALLS,
+                           [&](std::size_t call)
+                           {
+                               const auto data{legacy::serialise(server::VersionResponse{},
+                                                                 static_cast<std::uint32_t>(call))};
+                               tests::keepResult(data[8]);
+                           }),
+        tests::measureCall(CALLS,
+                           [&](std::size_t call)
+                           {
+                               server::serialise(server::VersionResponse{}, static_cast<std::uint32_t>(call), version);
+                               tests::keepResult(version[8]);
+                           }));
+
+    printResult(
+        "list ports:",
+        tests::measureCall(CALLS,
+                           [&](std::size_t call)
+                           {
+                               const auto data{legacy::serialise(server::ListPortsResponse{pad_index, gamepad_data},
+                                                                 static_cast<std::uint32_t>(call))};
+                               tests::keepResult(data[8]);
+                           }),
+        tests::measureCall(CALLS,
+                           [&](std::size_t call)
+                           {
+                               server::serialise(server::ListPortsResponse{pad_index, gamepad_data},
+                                                 static_cast<std::uint32_t>(call), list_ports);
+                               tests::keepResult(list_ports[8]);
+                           }));
+
+    printResult(
+        "pad data:",
+        tests::measureCall(CALLS,
+                           [&](std::size_t call)
+                           {
+                               const auto data{legacy::serialise(legacy::PadDataResponse{pad_index, gamepad_data, 0},
+                                                                 static_cast<std::uint32_t>(call))};
+                               tests::keepResult(data[8]);
+                           }),
+        tests::measureCall(CALLS,
+                           [&](std::size_t call)
+                           {
+                               server::serialise(server::PadDataResponse{pad_index, gamepad_data},
+                                                 static_cast<std::uint32_t>(call), pad_data);
+                               tests::keepResult(pad_data[8]);
+                           }));
+
+    // What each of the subscribers of a pad costs: previously the whole packet was encoded for each of them, now the
+    // packet is encoded once and only its copies get their own packet counter
+    printResult(
+        "pad data, per client:",
+        tests::measureCall(
+            CALLS,
+            [&](std::size_t call)
+            {
+                const auto data{legacy::serialise(
+                    legacy::PadDataResponse{pad_index, gamepad_data, static_cast<std::uint32_t>(call)}, SERVER_ID)};
+                tests::keepResult(data[8]);
+            }),
+        tests::measureCall(CALLS,
+                           [&](std::size_t call)
+                           {
+                               client_pad_data = pad_data;
+                               server::updatePacketCounter(client_pad_data, static_cast<std::uint32_t>(call));
+                               tests::keepResult(client_pad_data[8]);
+                           }));
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,73 @@
+// system includes
+#include <algorithm>
+#include <boost/log/core.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/trivial.hpp>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+// local includes
+#include "fanoutmeasurement.h"
+
+//--------------------------------------------------------------------------------------------------
+
+// Measures how the pad data throughput scales with the number of server workers (sharing the port via
+// `SO_REUSEPORT`), with a few hundred clients on the loopback interface. Only the counts up to the number of cores
+// (but at least 2) are measured.
+
+//--------------------------------------------------------------------------------------------------
+
+namespace
+{
+using namespace std::chrono_literals;
+
+constexpr std::size_t CLIENTS{512};
+constexpr auto        DURATION{2000ms};
+}  // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+int main()
+{
+    boost::log::core::get()->set_filter(boost::log::trivial::severity >= boost::log::trivial::warning);
+
+    const std::size_t max_workers{std::max<std::size_t>(2, std::thread::hardware_concurrency())};
+    std::cout << "Cores: " << std::thread::hardware_concurrency() << ", clients: " << CLIENTS << std::endl;
+
+    try
+    {
+        double single_worker_rate{0};
+        for (std::size_t worker_count = 1; worker_count <= max_workers; worker_count *= 2)
+        {
+            server::NetworkSettings network_settings;
+            network_settings.m_workers = worker_count;
+
+            const auto result{tests::measureServerFanOut(network_settings, CLIENTS, DURATION)};
+            if (worker_count == 1)
+            {
+                single_worker_rate = result.getPacketsPerSecond();
+            }
+
+            std::cout << "Clients per worker:";
+            for (const auto clients : result.m_clients_per_worker)
+            {
+                std::cout << " " << clients;
+            }
+            std::cout << std::endl;
+
+            std::cout << std::fixed << std::setprecision(2) << "Workers: " << std::setw(2) << worker_count
+                      << ", updates/s: " << std::setw(10) << result.getUpdatesPerSecond()
+                      << ", packets/s: " << std::setw(12) << result.getPacketsPerSecond()
+                      << ", speedup: " << result.getPacketsPerSecond() / single_worker_rate << std::endl;
+        }
+    }
+    catch (const std::exception& exception)
+    {
+        std::cout << exception.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}